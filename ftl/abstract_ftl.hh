@@ -21,6 +21,7 @@
 #define __FTL_ABSTRACT_FTL__
 
 #include <cinttypes>
+#include <vector>
 
 #include "ftl/ftl.hh"
 
@@ -48,7 +49,12 @@ class AbstractFTL : public StatObject {
 
   virtual void read(Request &, uint64_t &) = 0;
   virtual void write(Request &, uint64_t &) = 0;
+  virtual void read(std::vector<Request> &, uint64_t &) = 0;
+  // Batched write also gives finish tick of each request
+  virtual void write(std::vector<Request> &, std::vector<uint64_t> &,
+                     uint64_t &) = 0;
   virtual void trim(Request &, uint64_t &) = 0;
+  virtual void trim(LPNRange &, uint64_t &) = 0;
 
   virtual void format(LPNRange &, uint64_t &) = 0;
 
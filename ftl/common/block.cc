@@ -30,13 +30,13 @@ namespace FTL {
 Block::Block(uint32_t count, uint32_t ioUnit)
     : pageCount(count),
       ioUnitInPage(ioUnit),
-      nextWritePageIndex(std::vector<uint32_t>(ioUnitInPage, 0)),
-      validBits(
-          std::vector<DynamicBitset>(pageCount, DynamicBitset(ioUnitInPage))),
-      erasedBits(
-          std::vector<DynamicBitset>(pageCount, DynamicBitset(ioUnitInPage))),
-      lpns(std::vector<std::vector<uint64_t>>(
-          pageCount, std::vector<uint64_t>(ioUnitInPage, 0))),
+      wordsInPage((ioUnit - 1) / 64 + 1),
+      nextWritePageIndex(ioUnitInPage, 0),
+      validBits(pageCount * wordsInPage, 0),
+      erasedBits(pageCount * wordsInPage, 0),
+      lpns(pageCount * ioUnitInPage, 0),
+      validPageCount(0),
+      dirtyPageCount(0),
       lastAccessed(0),
       eraseCount(0) {
   erase();
@@ -45,6 +45,33 @@ Block::Block(uint32_t count, uint32_t ioUnit)
 
 Block::~Block() {}
 
+bool Block::isValid(uint32_t pageIndex) {
+  uint64_t *valid = validBits.data() + pageIndex * wordsInPage;
+
+  for (uint32_t i = 0; i < wordsInPage; i++) {
+    if (valid[i]) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Block::isDirty(uint32_t pageIndex) {
+  uint64_t *valid = validBits.data() + pageIndex * wordsInPage;
+  uint64_t *erased = erasedBits.data() + pageIndex * wordsInPage;
+
+  // Dirty: Valid(false), Erased(false)
+  // Unused bits in last word are always marked as erased
+  for (uint32_t i = 0; i < wordsInPage; i++) {
+    if (~(valid[i] | erased[i])) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 uint64_t Block::getLastAccessedTime() {
   return lastAccessed;
 }
@@ -54,28 +81,11 @@ uint32_t Block::getEraseCount() {
 }
 
 uint32_t Block::getValidPageCount() {
-  uint32_t ret = 0;
-
-  for (auto &iter : validBits) {
-    if (iter.any()) {
-      ret++;
-    }
-  }
-
-  return ret;
+  return validPageCount;
 }
 
 uint32_t Block::getDirtyPageCount() {
-  uint32_t ret = 0;
-
-  for (uint32_t i = 0; i < pageCount; i++) {
-    // Dirty: Valid(false), Erased(false)
-    if ((~(validBits.at(i) | erasedBits.at(i))).any()) {
-      ret++;
-    }
-  }
-
-  return ret;
+  return dirtyPageCount;
 }
 
 uint32_t Block::getNextWritePageIndex() {
@@ -89,15 +99,24 @@ uint32_t Block::getNextWritePageIndex(uint32_t idx) {
 
 bool Block::getPageInfo(uint32_t pageIndex, std::vector<uint64_t> &lpn,
                         DynamicBitset &map) {
-  map = validBits.at(pageIndex);
-  lpn = lpns.at(pageIndex);
+  uint64_t *valid = validBits.data() + pageIndex * wordsInPage;
+  auto begin = lpns.begin() + pageIndex * ioUnitInPage;
+
+  lpn.assign(begin, begin + ioUnitInPage);
+  map.reset();
+
+  for (uint32_t idx = 0; idx < ioUnitInPage; idx++) {
+    if (valid[idx / 64] & (1ull << (idx % 64))) {
+      map.set(idx);
+    }
+  }
 
-  return map.any();
+  return isValid(pageIndex);
 }
 
 bool Block::read(uint32_t pageIndex, uint32_t idx, uint64_t tick) {
-  auto valid = validBits.at(pageIndex);
-  bool read = valid.test(idx);
+  bool read = validBits[pageIndex * wordsInPage + idx / 64] &
+              (1ull << (idx % 64));
 
   if (read) {
     lastAccessed = tick;
@@ -108,20 +127,25 @@ bool Block::read(uint32_t pageIndex, uint32_t idx, uint64_t tick) {
 
 bool Block::write(uint32_t pageIndex, uint64_t lpn, uint32_t idx,
                   uint64_t tick) {
-  auto valid = erasedBits.at(pageIndex);
-  bool write = valid.test(idx);
+  uint64_t &erased = erasedBits[pageIndex * wordsInPage + idx / 64];
+  uint64_t mask = 1ull << (idx % 64);
+  bool write = erased & mask;
 
   if (write) {
     if (pageIndex < nextWritePageIndex[idx]) {
       Logger::panic("Write to block should sequential");
     }
 
+    if (!isValid(pageIndex)) {
+      validPageCount++;
+    }
+
     lastAccessed = tick;
-    erasedBits.at(pageIndex).reset(idx);
-    validBits.at(pageIndex).set(idx);
+    erased &= ~mask;
+    validBits[pageIndex * wordsInPage + idx / 64] |= mask;
 
     nextWritePageIndex[idx] = pageIndex + 1;
-    lpns.at(pageIndex).at(idx) = lpn;
+    lpns[pageIndex * ioUnitInPage + idx] = lpn;
   }
   else {
     Logger::panic("Write to non erased page");
@@ -130,22 +154,73 @@ bool Block::write(uint32_t pageIndex, uint64_t lpn, uint32_t idx,
   return write;
 }
 
-void Block::erase() {
-  for (auto &iter : validBits) {
-    iter.reset();
+void Block::writePage(uint32_t pageIndex, uint64_t lpn, uint64_t tick) {
+  uint64_t *valid = validBits.data() + pageIndex * wordsInPage;
+  uint64_t *erased = erasedBits.data() + pageIndex * wordsInPage;
+  uint64_t lastMask = ~0ull;
+
+  if (ioUnitInPage % 64) {
+    lastMask = (1ull << (ioUnitInPage % 64)) - 1;
   }
-  for (auto &iter : erasedBits) {
-    iter.set();
+
+  for (uint32_t i = 0; i < wordsInPage; i++) {
+    uint64_t mask = i + 1 == wordsInPage ? lastMask : ~0ull;
+
+    if ((erased[i] & mask) != mask) {
+      Logger::panic("Write to non erased page");
+    }
   }
-  for (auto &iter : nextWritePageIndex) {
-    iter = 0;
+
+  for (uint32_t idx = 0; idx < ioUnitInPage; idx++) {
+    if (pageIndex < nextWritePageIndex[idx]) {
+      Logger::panic("Write to block should sequential");
+    }
+  }
+
+  // Write all I/O units at once
+  for (uint32_t i = 0; i < wordsInPage; i++) {
+    uint64_t mask = i + 1 == wordsInPage ? lastMask : ~0ull;
+
+    erased[i] &= ~mask;
+    valid[i] |= mask;
   }
 
+  std::fill(nextWritePageIndex.begin(), nextWritePageIndex.end(),
+            pageIndex + 1);
+  std::fill(lpns.begin() + pageIndex * ioUnitInPage,
+            lpns.begin() + (pageIndex + 1) * ioUnitInPage, lpn);
+
+  validPageCount++;
+  lastAccessed = tick;
+}
+
+void Block::erase() {
+  std::fill(validBits.begin(), validBits.end(), 0);
+  std::fill(erasedBits.begin(), erasedBits.end(), ~0ull);
+  std::fill(nextWritePageIndex.begin(), nextWritePageIndex.end(), 0);
+
+  validPageCount = 0;
+  dirtyPageCount = 0;
+
   eraseCount++;
 }
 
 void Block::invalidate(uint32_t pageIndex, uint32_t idx) {
-  validBits.at(pageIndex).reset(idx);
+  uint64_t &valid = validBits[pageIndex * wordsInPage + idx / 64];
+  uint64_t mask = 1ull << (idx % 64);
+
+  if (valid & mask) {
+    // Valid unit is never erased, so this unit becomes dirty
+    if (!isDirty(pageIndex)) {
+      dirtyPageCount++;
+    }
+
+    valid &= ~mask;
+
+    if (!isValid(pageIndex)) {
+      validPageCount--;
+    }
+  }
 }
 
 }  // namespace FTL
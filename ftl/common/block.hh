@@ -31,30 +31,43 @@ namespace FTL {
 
 class Block {
  private:
-  const uint32_t pageCount;
-  const uint32_t ioUnitInPage;
+  uint32_t pageCount;
+  uint32_t ioUnitInPage;
+  uint32_t wordsInPage;  //!< # 64bit words for bitmap of one page
   std::vector<uint32_t> nextWritePageIndex;
 
-  std::vector<DynamicBitset> validBits;
-  std::vector<DynamicBitset> erasedBits;
-  std::vector<std::vector<uint64_t>> lpns;
+  std::vector<uint64_t> validBits;
+  std::vector<uint64_t> erasedBits;
+  std::vector<uint64_t> lpns;
+
+  uint32_t validPageCount;  //!< # pages with at least one valid unit
+  uint32_t dirtyPageCount;  //!< # pages with at least one invalidated unit
 
   uint64_t lastAccessed;
   uint32_t eraseCount;
 
+  bool isDirty(uint32_t);
+
  public:
   Block(uint32_t, uint32_t);
+  Block(const Block &) = delete;
+  Block(Block &&) noexcept = default;
   ~Block();
 
+  Block &operator=(const Block &) = delete;
+  Block &operator=(Block &&) noexcept = default;
+
   uint64_t getLastAccessedTime();
   uint32_t getEraseCount();
   uint32_t getValidPageCount();
   uint32_t getDirtyPageCount();
+  bool isValid(uint32_t);
   uint32_t getNextWritePageIndex();
   uint32_t getNextWritePageIndex(uint32_t);
   bool getPageInfo(uint32_t, std::vector<uint64_t> &, DynamicBitset &);
   bool read(uint32_t, uint32_t, uint64_t);
   bool write(uint32_t, uint64_t, uint32_t, uint64_t);
+  void writePage(uint32_t, uint64_t, uint64_t);
   void erase();
   void invalidate(uint32_t, uint32_t);
 };
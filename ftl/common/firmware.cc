@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ftl/common/firmware.hh"
+
+#include <algorithm>
+#include <string>
+
+#include "util/algorithm.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+static const char *opName[FIRMWARE_OPERATION_COUNT] = {
+    "map_lookup",
+    "map_update",
+    "gc",
+    "cache_lookup",
+};
+
+Firmware::Firmware(Config &conf)
+    : cost(FIRMWARE_OPERATION_COUNT, 0),
+      busyUntil(conf.readUint(FTL_FIRMWARE_CORE), 0) {
+  cost.at(FIRMWARE_MAP_LOOKUP) = conf.readUint(FTL_MAP_LOOKUP_LATENCY);
+  cost.at(FIRMWARE_MAP_UPDATE) = conf.readUint(FTL_MAP_UPDATE_LATENCY);
+  cost.at(FIRMWARE_GC) = conf.readUint(FTL_GC_LATENCY);
+  cost.at(FIRMWARE_CACHE_LOOKUP) = conf.readUint(FTL_CACHE_LOOKUP_LATENCY);
+
+  stat.coreBusy.resize(busyUntil.size(), 0);
+  stat.opCount.resize(FIRMWARE_OPERATION_COUNT, 0);
+  stat.opTime.resize(FIRMWARE_OPERATION_COUNT, 0);
+  stat.beginAt = 0;
+  stat.lastAt = 0;
+}
+
+Firmware::~Firmware() {}
+
+void Firmware::execute(FIRMWARE_OPERATION op, uint32_t count,
+                       uint64_t &tick) {
+  uint64_t latency = cost.at(op) * count;
+
+  // Tick 0 is used for untimed work, such as warm-up
+  if (tick == 0) {
+    return;
+  }
+
+  stat.opCount.at(op) += count;
+
+  if (latency == 0) {
+    return;
+  }
+
+  uint32_t core = 0;
+
+  for (uint32_t i = 1; i < busyUntil.size(); i++) {
+    if (busyUntil.at(i) < busyUntil.at(core)) {
+      core = i;
+    }
+  }
+
+  tick = MAX(tick, busyUntil.at(core)) + latency;
+  busyUntil.at(core) = tick;
+
+  stat.coreBusy.at(core) += latency;
+  stat.opTime.at(op) += latency;
+  stat.lastAt = MAX(stat.lastAt, tick);
+}
+
+void Firmware::getStats(std::vector<Stats> &list) {
+  Stats temp;
+
+  for (uint32_t i = 0; i < FIRMWARE_OPERATION_COUNT; i++) {
+    temp.name = std::string("ftl.firmware.") + opName[i] + ".count";
+    temp.desc = std::string("Total items of ") + opName[i] + " operation";
+    list.push_back(temp);
+
+    temp.name = std::string("ftl.firmware.") + opName[i] + ".time";
+    temp.desc = std::string("Total core time of ") + opName[i] + " operation";
+    list.push_back(temp);
+  }
+
+  for (uint32_t i = 0; i < busyUntil.size(); i++) {
+    temp.name = "ftl.firmware.core" + std::to_string(i) + ".busy";
+    temp.desc = "Busy time of firmware core " + std::to_string(i);
+    list.push_back(temp);
+
+    temp.name = "ftl.firmware.core" + std::to_string(i) + ".utilization";
+    temp.desc = "Busy time of firmware core " + std::to_string(i) +
+                " over elapsed time (0.01%)";
+    list.push_back(temp);
+  }
+}
+
+void Firmware::getStatValues(std::vector<uint64_t> &values) {
+  uint64_t elapsed = stat.lastAt - MIN(stat.beginAt, stat.lastAt);
+
+  for (uint32_t i = 0; i < FIRMWARE_OPERATION_COUNT; i++) {
+    values.push_back(stat.opCount.at(i));
+    values.push_back(stat.opTime.at(i));
+  }
+
+  for (auto &iter : stat.coreBusy) {
+    values.push_back(iter);
+    values.push_back(
+        elapsed > 0 ? (uint64_t)((double)MIN(iter, elapsed) / elapsed * 10000)
+                    : 0);
+  }
+}
+
+void Firmware::resetStats() {
+  std::fill(stat.coreBusy.begin(), stat.coreBusy.end(), 0);
+  std::fill(stat.opCount.begin(), stat.opCount.end(), 0);
+  std::fill(stat.opTime.begin(), stat.opTime.end(), 0);
+
+  stat.beginAt = stat.lastAt;
+}
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
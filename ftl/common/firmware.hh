@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FTL_COMMON_FIRMWARE__
+#define __FTL_COMMON_FIRMWARE__
+
+#include <cinttypes>
+#include <vector>
+
+#include "ftl/config.hh"
+#include "util/def.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+typedef enum {
+  FIRMWARE_MAP_LOOKUP,    //!< Host read, per I/O unit
+  FIRMWARE_MAP_UPDATE,    //!< Host write, per I/O unit
+  FIRMWARE_GC,            //!< GC bookkeeping, per migrated I/O unit
+  FIRMWARE_CACHE_LOOKUP,  //!< ICL cache tag lookup, per request
+  FIRMWARE_OPERATION_COUNT,
+} FIRMWARE_OPERATION;
+
+/**
+ * Embedded processor running FTL and ICL firmware
+ *
+ * Each operation costs a fixed time per item from the cost table, and runs
+ * on the core which becomes idle first. Busy time of each core tells
+ * whether firmware or NAND limits the throughput.
+ */
+class Firmware : public StatObject {
+ private:
+  std::vector<uint64_t> cost;       //!< Per-item cost of each operation
+  std::vector<uint64_t> busyUntil;  //!< Per-core
+
+  struct {
+    std::vector<uint64_t> coreBusy;
+    std::vector<uint64_t> opCount;
+    std::vector<uint64_t> opTime;
+    uint64_t beginAt;  //!< Last tick when stats are reset
+    uint64_t lastAt;   //!< Last tick seen
+  } stat;
+
+ public:
+  Firmware(Config &);
+  ~Firmware();
+
+  void execute(FIRMWARE_OPERATION, uint32_t, uint64_t &);
+
+  void getStats(std::vector<Stats> &) override;
+  void getStatValues(std::vector<uint64_t> &) override;
+  void resetStats() override;
+};
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ftl/common/histogram.hh"
+
+#include <algorithm>
+#include <limits>
+
+#include "util/algorithm.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+Histogram::Histogram() : buckets(16 + 60 * 8, 0) {
+  reset();
+}
+
+Histogram::~Histogram() {}
+
+uint32_t Histogram::getBucket(uint64_t value) {
+  if (value < 16) {
+    return value;
+  }
+
+  uint32_t exp = 63 - __builtin_clzll(value);
+
+  return 16 + (exp - 4) * 8 + ((value >> (exp - 3)) & 7);
+}
+
+uint64_t Histogram::getUpperBound(uint32_t bucket) {
+  if (bucket < 16) {
+    return bucket;
+  }
+
+  uint32_t exp = (bucket - 16) / 8 + 4;
+  uint64_t width = 1ull << (exp - 3);
+
+  return (8 + (bucket - 16) % 8) * width + width - 1;
+}
+
+void Histogram::add(uint64_t value) {
+  buckets.at(getBucket(value))++;
+
+  count++;
+  sum += value;
+  min = MIN(min, value);
+  max = MAX(max, value);
+}
+
+void Histogram::reset() {
+  std::fill(buckets.begin(), buckets.end(), 0);
+
+  count = 0;
+  sum = 0;
+  min = std::numeric_limits<uint64_t>::max();
+  max = 0;
+}
+
+uint64_t Histogram::getCount() {
+  return count;
+}
+
+uint64_t Histogram::getSum() {
+  return sum;
+}
+
+uint64_t Histogram::getMin() {
+  return count > 0 ? min : 0;
+}
+
+uint64_t Histogram::getMax() {
+  return max;
+}
+
+uint64_t Histogram::getPercentile(float ratio) {
+  uint64_t rank = (uint64_t)(count * ratio);
+  uint64_t seen = 0;
+
+  if (count == 0) {
+    return 0;
+  }
+
+  for (uint32_t i = 0; i < buckets.size(); i++) {
+    seen += buckets.at(i);
+
+    if (seen > rank) {
+      return MAX(MIN(getUpperBound(i), max), min);
+    }
+  }
+
+  return max;
+}
+
+void Histogram::getStats(std::vector<Stats> &list, std::string prefix,
+                         std::string desc) {
+  Stats temp;
+
+  temp.name = prefix + ".count";
+  temp.desc = "Number of " + desc;
+  list.push_back(temp);
+
+  temp.name = prefix + ".sum";
+  temp.desc = "Total latency of " + desc;
+  list.push_back(temp);
+
+  temp.name = prefix + ".min";
+  temp.desc = "Minimum latency of " + desc;
+  list.push_back(temp);
+
+  temp.name = prefix + ".max";
+  temp.desc = "Maximum latency of " + desc;
+  list.push_back(temp);
+
+  temp.name = prefix + ".p50";
+  temp.desc = "Median latency of " + desc;
+  list.push_back(temp);
+
+  temp.name = prefix + ".p90";
+  temp.desc = "90th percentile latency of " + desc;
+  list.push_back(temp);
+
+  temp.name = prefix + ".p99";
+  temp.desc = "99th percentile latency of " + desc;
+  list.push_back(temp);
+}
+
+void Histogram::getStatValues(std::vector<uint64_t> &values) {
+  values.push_back(getCount());
+  values.push_back(getSum());
+  values.push_back(getMin());
+  values.push_back(getMax());
+  values.push_back(getPercentile(0.5f));
+  values.push_back(getPercentile(0.9f));
+  values.push_back(getPercentile(0.99f));
+}
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
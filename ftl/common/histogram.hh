@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FTL_COMMON_HISTOGRAM__
+#define __FTL_COMMON_HISTOGRAM__
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "util/def.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+/**
+ * Log-linear histogram of latency samples
+ *
+ * Values below 16 have their own bucket, and each power of two above is
+ * split into 8 buckets. Percentiles are reported as upper bound of bucket,
+ * so error is at most 12.5%.
+ */
+class Histogram {
+ private:
+  std::vector<uint64_t> buckets;
+  uint64_t count;
+  uint64_t sum;
+  uint64_t min;
+  uint64_t max;
+
+  uint32_t getBucket(uint64_t);
+  uint64_t getUpperBound(uint32_t);
+
+ public:
+  Histogram();
+  ~Histogram();
+
+  void add(uint64_t);
+  void reset();
+
+  uint64_t getCount();
+  uint64_t getSum();
+  uint64_t getMin();
+  uint64_t getMax();
+  uint64_t getPercentile(float);
+
+  // Count, sum, min, max and percentiles, named after given prefix
+  void getStats(std::vector<Stats> &, std::string, std::string);
+  void getStatValues(std::vector<uint64_t> &);
+};
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
+
+#endif
@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ftl/common/mapping_table.hh"
+
+#include <algorithm>
+#include <iterator>
+
+#include "log/trace.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+#define UNMAPPED 0xFFFFFFFF
+
+MappingTable::MappingTable(uint64_t lpn, uint32_t ioUnit, uint32_t blockCount,
+                           uint32_t pageCount, bool extent, uint32_t slots)
+    : lpnCount(lpn),
+      ioUnitInPage(ioUnit),
+      pagesInBlock(pageCount),
+      stripe(slots),
+      pageBits(0),
+      mappedCount(0),
+      bExtent(extent) {
+  while ((1ull << pageBits) < pageCount) {
+    pageBits++;
+  }
+
+  pageMask = (1u << pageBits) - 1;
+
+  // Largest packed value must not collide with UNMAPPED
+  if (((uint64_t)blockCount << pageBits) >= UNMAPPED) {
+    Logger::panic("Too many physical pages to pack in mapping table");
+  }
+
+  if (!bExtent) {
+    table.resize(lpnCount * ioUnitInPage, UNMAPPED);
+  }
+}
+
+MappingTable::~MappingTable() {}
+
+bool MappingTable::anyMapped(uint64_t lpn) {
+  if (bExtent) {
+    if (findExtent(lpn) != extents.end() || pages.count(lpn) > 0) {
+      return true;
+    }
+
+    if (units.size() > 0) {
+      for (uint32_t idx = 0; idx < ioUnitInPage; idx++) {
+        if (units.count(lpn * ioUnitInPage + idx) > 0) {
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+  uint32_t *entry = table.data() + lpn * ioUnitInPage;
+
+  for (uint32_t idx = 0; idx < ioUnitInPage; idx++) {
+    if (entry[idx] != UNMAPPED) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool MappingTable::getMapping(uint64_t lpn, uint32_t idx, uint32_t &block,
+                              uint32_t &page) {
+  if (lpn >= lpnCount) {
+    return false;
+  }
+
+  uint32_t entry;
+
+  if (bExtent) {
+    auto iter = findExtent(lpn);
+
+    if (iter != extents.end()) {
+      entry = fromPPN(iter->second.ppn + (lpn - iter->first));
+    }
+    else {
+      auto single = pages.find(lpn);
+
+      if (single == pages.end()) {
+        single = units.find(lpn * ioUnitInPage + idx);
+
+        if (single == units.end()) {
+          return false;
+        }
+      }
+
+      entry = single->second;
+    }
+  }
+  else {
+    entry = table[lpn * ioUnitInPage + idx];
+
+    if (entry == UNMAPPED) {
+      return false;
+    }
+  }
+
+  block = entry >> pageBits;
+  page = entry & pageMask;
+
+  return true;
+}
+
+void MappingTable::setMapping(uint64_t lpn, uint32_t idx, uint32_t block,
+                              uint32_t page) {
+  if (lpn >= lpnCount) {
+    Logger::panic("LPN %" PRIu64 " out of range", lpn);
+  }
+
+  if (bExtent) {
+    uint32_t ppn;
+
+    if (anyMapped(lpn)) {
+      expandPage(lpn);
+    }
+    else {
+      mappedCount++;
+    }
+
+    units[lpn * ioUnitInPage + idx] = (block << pageBits) | page;
+
+    // Units are set in ascending order, so try to join a run after last one
+    if (idx == ioUnitInPage - 1 && getUnitsPPN(lpn, ppn)) {
+      eraseUnits(lpn);
+      insertPage(lpn, ppn);
+    }
+
+    return;
+  }
+
+  uint32_t &entry = table[lpn * ioUnitInPage + idx];
+
+  if (entry == UNMAPPED && !anyMapped(lpn)) {
+    mappedCount++;
+  }
+
+  entry = (block << pageBits) | page;
+}
+
+void MappingTable::setMapping(uint64_t lpn, uint32_t block, uint32_t page) {
+  if (lpn >= lpnCount) {
+    Logger::panic("LPN %" PRIu64 " out of range", lpn);
+  }
+
+  if (bExtent) {
+    if (anyMapped(lpn)) {
+      expandPage(lpn);
+      eraseUnits(lpn);
+    }
+    else {
+      mappedCount++;
+    }
+
+    insertPage(lpn, toPPN((block << pageBits) | page));
+
+    return;
+  }
+
+  uint32_t *entry = table.data() + lpn * ioUnitInPage;
+
+  if (!anyMapped(lpn)) {
+    mappedCount++;
+  }
+
+  std::fill(entry, entry + ioUnitInPage, (block << pageBits) | page);
+}
+
+bool MappingTable::resetMapping(uint64_t lpn, uint32_t idx) {
+  if (lpn >= lpnCount) {
+    return false;
+  }
+
+  if (bExtent) {
+    expandPage(lpn);
+
+    if (units.erase(lpn * ioUnitInPage + idx) == 0) {
+      return false;
+    }
+  }
+  else {
+    uint32_t &entry = table[lpn * ioUnitInPage + idx];
+
+    if (entry == UNMAPPED) {
+      return false;
+    }
+
+    entry = UNMAPPED;
+  }
+
+  if (!anyMapped(lpn)) {
+    mappedCount--;
+  }
+
+  return true;
+}
+
+bool MappingTable::resetMapping(uint64_t lpn) {
+  if (lpn >= lpnCount || !anyMapped(lpn)) {
+    return false;
+  }
+
+  if (bExtent) {
+    auto iter = findExtent(lpn);
+
+    // Whole page is removed, so no need to expand it to unit entries
+    if (iter != extents.end()) {
+      splitExtent(iter, lpn);
+    }
+    else if (pages.erase(lpn) == 0) {
+      eraseUnits(lpn);
+    }
+  }
+  else {
+    std::fill_n(table.begin() + lpn * ioUnitInPage, ioUnitInPage, UNMAPPED);
+  }
+
+  mappedCount--;
+
+  return true;
+}
+
+bool MappingTable::isMapped(uint64_t lpn) {
+  if (lpn >= lpnCount) {
+    return false;
+  }
+
+  return anyMapped(lpn);
+}
+
+uint64_t MappingTable::getLPNCount() {
+  return lpnCount;
+}
+
+uint64_t MappingTable::getMappedCount() {
+  return mappedCount;
+}
+
+uint64_t MappingTable::getTableSize() {
+  if (bExtent) {
+    // Extent holds start LPN, start PPN and length, and page or unit entry
+    // holds its index and packed entry
+    return extents.size() * 16 + (pages.size() + units.size()) * 12;
+  }
+
+  return table.size() * sizeof(uint32_t);
+}
+
+uint64_t MappingTable::getDenseTableSize() {
+  return lpnCount * ioUnitInPage * sizeof(uint32_t);
+}
+
+uint64_t MappingTable::getExtentCount() {
+  return extents.size();
+}
+
+uint64_t MappingTable::getPageEntryCount() {
+  return pages.size();
+}
+
+uint64_t MappingTable::getUnitEntryCount() {
+  return units.size();
+}
+
+uint32_t MappingTable::toPPN(uint32_t entry) {
+  uint32_t block = entry >> pageBits;
+
+  return ((block / stripe) * pagesInBlock + (entry & pageMask)) * stripe +
+         block % stripe;
+}
+
+uint32_t MappingTable::fromPPN(uint32_t ppn) {
+  uint32_t row = ppn / stripe;
+  uint32_t block = (row / pagesInBlock) * stripe + ppn % stripe;
+
+  return (block << pageBits) | (row % pagesInBlock);
+}
+
+std::map<uint64_t, MappingTable::Extent>::iterator MappingTable::findExtent(
+    uint64_t lpn) {
+  auto iter = extents.upper_bound(lpn);
+
+  if (iter == extents.begin()) {
+    return extents.end();
+  }
+
+  --iter;
+
+  if (lpn - iter->first < iter->second.length) {
+    return iter;
+  }
+
+  return extents.end();
+}
+
+void MappingTable::splitExtent(std::map<uint64_t, Extent>::iterator iter,
+                               uint64_t lpn) {
+  uint64_t start = iter->first;
+  uint32_t ppn = iter->second.ppn;
+  uint32_t head = lpn - start;
+  uint32_t tail = iter->second.length - head - 1;
+
+  // Runs shorter than two pages are kept as page entries
+  if (head >= 2) {
+    iter->second.length = head;
+  }
+  else {
+    extents.erase(iter);
+
+    if (head == 1) {
+      setPage(start, ppn);
+    }
+  }
+
+  if (tail >= 2) {
+    extents.emplace(lpn + 1, Extent{ppn + head + 1, tail});
+  }
+  else if (tail == 1) {
+    setPage(lpn + 1, ppn + head + 1);
+  }
+}
+
+void MappingTable::setPage(uint64_t lpn, uint32_t ppn) {
+  pages[lpn] = fromPPN(ppn);
+}
+
+bool MappingTable::getPagePPN(uint64_t lpn, uint32_t &ppn) {
+  auto iter = pages.find(lpn);
+
+  if (iter == pages.end()) {
+    return false;
+  }
+
+  ppn = toPPN(iter->second);
+
+  return true;
+}
+
+void MappingTable::expandPage(uint64_t lpn) {
+  auto iter = findExtent(lpn);
+  uint32_t entry;
+
+  // Move mapping of this page to per-unit entries
+  if (iter != extents.end()) {
+    entry = fromPPN(iter->second.ppn + (lpn - iter->first));
+
+    splitExtent(iter, lpn);
+  }
+  else {
+    auto page = pages.find(lpn);
+
+    if (page == pages.end()) {
+      return;
+    }
+
+    entry = page->second;
+
+    pages.erase(page);
+  }
+
+  for (uint32_t idx = 0; idx < ioUnitInPage; idx++) {
+    units[lpn * ioUnitInPage + idx] = entry;
+  }
+}
+
+bool MappingTable::getUnitsPPN(uint64_t lpn, uint32_t &ppn) {
+  uint32_t entry = UNMAPPED;
+
+  // All units must be in one physical page
+  for (uint32_t idx = 0; idx < ioUnitInPage; idx++) {
+    auto iter = units.find(lpn * ioUnitInPage + idx);
+
+    if (iter == units.end() || (idx > 0 && iter->second != entry)) {
+      return false;
+    }
+
+    entry = iter->second;
+  }
+
+  ppn = toPPN(entry);
+
+  return true;
+}
+
+void MappingTable::eraseUnits(uint64_t lpn) {
+  for (uint32_t idx = 0; idx < ioUnitInPage; idx++) {
+    units.erase(lpn * ioUnitInPage + idx);
+  }
+}
+
+void MappingTable::insertPage(uint64_t lpn, uint32_t ppn) {
+  auto next = extents.upper_bound(lpn);
+  uint64_t start = lpn;
+  uint32_t startPPN = ppn;
+  uint32_t length = 1;
+  uint32_t neighbor;
+
+  // Join run or page right before this page
+  if (next != extents.begin()) {
+    auto prev = std::prev(next);
+
+    if (prev->first + prev->second.length == lpn &&
+        prev->second.ppn + prev->second.length == ppn) {
+      start = prev->first;
+      startPPN = prev->second.ppn;
+      length += prev->second.length;
+
+      extents.erase(prev);
+    }
+  }
+
+  if (length == 1 && lpn > 0 && getPagePPN(lpn - 1, neighbor) &&
+      neighbor + 1 == ppn) {
+    pages.erase(lpn - 1);
+
+    start--;
+    startPPN--;
+    length++;
+  }
+
+  // Join run or page right after this page
+  if (next != extents.end() && next->first == lpn + 1 &&
+      next->second.ppn == ppn + 1) {
+    length += next->second.length;
+
+    extents.erase(next);
+  }
+  else if (lpn + 1 < lpnCount && getPagePPN(lpn + 1, neighbor) &&
+           neighbor == ppn + 1) {
+    pages.erase(lpn + 1);
+
+    length++;
+  }
+
+  if (length == 1) {
+    setPage(lpn, ppn);
+  }
+  else {
+    extents.emplace(start, Extent{startPPN, length});
+  }
+}
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
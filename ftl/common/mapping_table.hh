@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FTL_COMMON_MAPPING_TABLE__
+#define __FTL_COMMON_MAPPING_TABLE__
+
+#include <cinttypes>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+/**
+ * LPN-indexed mapping table
+ *
+ * One 32bit entry per I/O unit of every logical page. Block index and page
+ * index are packed into one entry, and unmapped entries hold a sentinel.
+ *
+ * In extent mode, runs of fully written logical pages stored in consecutive
+ * physical pages are kept as (start LPN, start PPN, length). PPNs are
+ * numbered across parallelism slots, so sequential writes striped over slots
+ * are consecutive. Other pages fall back to sparse per-page entries, and
+ * partially written pages to per-unit entries.
+ */
+class MappingTable {
+ private:
+  struct Extent {
+    uint32_t ppn;
+    uint32_t length;
+  };
+
+  const uint64_t lpnCount;
+  const uint32_t ioUnitInPage;
+  const uint32_t pagesInBlock;
+  const uint32_t stripe;  //!< # parallelism slots
+  uint32_t pageBits;
+  uint32_t pageMask;
+
+  std::vector<uint32_t> table;
+  uint64_t mappedCount;  //!< # logical pages with at least one mapped unit
+
+  // Extent mode
+  bool bExtent;
+  std::map<uint64_t, Extent> extents;           //!< Start LPN -> run
+  std::unordered_map<uint64_t, uint32_t> pages;  //!< LPN -> packed entry
+  std::unordered_map<uint64_t, uint32_t> units;  //!< Unit -> packed entry
+
+  bool anyMapped(uint64_t);
+
+  uint32_t toPPN(uint32_t);
+  uint32_t fromPPN(uint32_t);
+  std::map<uint64_t, Extent>::iterator findExtent(uint64_t);
+  void splitExtent(std::map<uint64_t, Extent>::iterator, uint64_t);
+  void setPage(uint64_t, uint32_t);
+  bool getPagePPN(uint64_t, uint32_t &);
+  void expandPage(uint64_t);
+  bool getUnitsPPN(uint64_t, uint32_t &);
+  void eraseUnits(uint64_t);
+  void insertPage(uint64_t, uint32_t);
+
+ public:
+  MappingTable(uint64_t, uint32_t, uint32_t, uint32_t, bool = false,
+               uint32_t = 1);
+  ~MappingTable();
+
+  bool getMapping(uint64_t, uint32_t, uint32_t &, uint32_t &);
+  void setMapping(uint64_t, uint32_t, uint32_t, uint32_t);
+  void setMapping(uint64_t, uint32_t, uint32_t);
+  bool resetMapping(uint64_t, uint32_t);
+  bool resetMapping(uint64_t);
+  bool isMapped(uint64_t);
+
+  uint64_t getLPNCount();
+  uint64_t getMappedCount();
+  uint64_t getTableSize();
+  uint64_t getDenseTableSize();
+  uint64_t getExtentCount();
+  uint64_t getPageEntryCount();
+  uint64_t getUnitEntryCount();
+};
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
+
+#endif
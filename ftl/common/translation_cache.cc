@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ftl/common/translation_cache.hh"
+
+#include "log/trace.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+TranslationCache::TranslationCache(uint64_t size) : capacity(size) {
+  cached.reserve(capacity);
+}
+
+TranslationCache::~TranslationCache() {}
+
+bool TranslationCache::access(uint64_t tpn) {
+  auto found = cached.find(tpn);
+
+  if (found == cached.end()) {
+    return false;
+  }
+
+  // Move to MRU position
+  lru.splice(lru.begin(), lru, found->second.iter);
+
+  return true;
+}
+
+bool TranslationCache::isFull() {
+  return cached.size() >= capacity;
+}
+
+void TranslationCache::insert(uint64_t tpn) {
+  if (cached.find(tpn) != cached.end()) {
+    Logger::panic("Translation page %" PRIu64 " already cached", tpn);
+  }
+
+  if (isFull()) {
+    Logger::panic("Translation cache is full");
+  }
+
+  lru.push_front(tpn);
+  cached.emplace(tpn, Entry{lru.begin(), false});
+}
+
+uint64_t TranslationCache::evict(bool &dirty) {
+  if (lru.empty()) {
+    Logger::panic("Translation cache is empty");
+  }
+
+  uint64_t tpn = lru.back();
+  auto found = cached.find(tpn);
+
+  dirty = found->second.dirty;
+
+  cached.erase(found);
+  lru.pop_back();
+
+  return tpn;
+}
+
+bool TranslationCache::setDirty(uint64_t tpn) {
+  auto found = cached.find(tpn);
+
+  if (found == cached.end()) {
+    return false;
+  }
+
+  found->second.dirty = true;
+
+  return true;
+}
+
+uint64_t TranslationCache::getCapacity() {
+  return capacity;
+}
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
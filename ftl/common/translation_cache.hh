@@ -17,28 +17,46 @@
  * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#ifndef __FTL_LATENCY__
-#define __FTL_LATENCY__
+#ifndef __FTL_COMMON_TRANSLATION_CACHE__
+#define __FTL_COMMON_TRANSLATION_CACHE__
 
 #include <cinttypes>
-#include <queue>
-#include <vector>
+#include <list>
+#include <unordered_map>
 
 namespace SimpleSSD {
 
 namespace FTL {
 
-class Latency {
+/**
+ * LRU list of translation pages cached in controller DRAM (DFTL)
+ *
+ * Only residency and dirtiness of each translation page are tracked here.
+ * Mapping entries themselves are kept in MappingTable.
+ */
+class TranslationCache {
  private:
-  std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>>
-      lastFTLRequestAt;
-  uint64_t latency;
+  struct Entry {
+    std::list<uint64_t>::iterator iter;
+    bool dirty;
+  };
+
+  const uint64_t capacity;  //!< # translation pages
+
+  std::list<uint64_t> lru;  //!< Most recently used page first
+  std::unordered_map<uint64_t, Entry> cached;
 
  public:
-  Latency(uint64_t, uint64_t);
-  ~Latency();
+  TranslationCache(uint64_t);
+  ~TranslationCache();
+
+  bool access(uint64_t);
+  bool isFull();
+  void insert(uint64_t);
+  uint64_t evict(bool &);
+  bool setDirty(uint64_t);
 
-  void access(uint32_t size, uint64_t &tick);
+  uint64_t getCapacity();
 };
 
 }  // namespace FTL
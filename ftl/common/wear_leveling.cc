@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ftl/common/wear_leveling.hh"
+
+#include "log/trace.hh"
+#include "util/algorithm.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+// Bucket 0 holds fresh blocks, bucket k holds [2^(k-1), 2^k) erases
+static uint32_t getBucketIndex(uint32_t eraseCount) {
+  uint32_t bucket = 0;
+
+  while (eraseCount > 0) {
+    eraseCount >>= 1;
+    bucket++;
+  }
+
+  return bucket;
+}
+
+WearLeveling::WearLeveling(uint32_t t, uint32_t i, uint32_t blockCount,
+                           uint64_t maxEraseCount)
+    : threshold(t),
+      interval(i),
+      bucketCount(getBucketIndex(MAX(maxEraseCount, 1) - 1) + 1),
+      erasesSinceCheck(0),
+      retiredBlocks(0) {
+  eraseCounts.emplace(0, blockCount);
+}
+
+WearLeveling::~WearLeveling() {}
+
+void WearLeveling::erase(uint32_t eraseCount, bool retired) {
+  auto iter = eraseCounts.find(eraseCount - 1);
+
+  if (eraseCount == 0 || iter == eraseCounts.end()) {
+    Logger::panic("Erase count distribution corrupted");
+  }
+
+  if (--iter->second == 0) {
+    eraseCounts.erase(iter);
+  }
+
+  if (retired) {
+    retiredBlocks++;
+  }
+  else {
+    eraseCounts[eraseCount]++;
+  }
+
+  erasesSinceCheck++;
+}
+
+bool WearLeveling::isTriggered() {
+  if (threshold == 0 || erasesSinceCheck < interval || eraseCounts.empty()) {
+    return false;
+  }
+
+  erasesSinceCheck = 0;
+
+  return getMaxEraseCount() - getMinEraseCount() > threshold;
+}
+
+bool WearLeveling::isCold(uint32_t eraseCount) {
+  return getMaxEraseCount() - eraseCount > threshold;
+}
+
+uint32_t WearLeveling::getMinEraseCount() {
+  return eraseCounts.empty() ? 0 : eraseCounts.begin()->first;
+}
+
+uint32_t WearLeveling::getMaxEraseCount() {
+  return eraseCounts.empty() ? 0 : eraseCounts.rbegin()->first;
+}
+
+uint64_t WearLeveling::getRetiredBlockCount() {
+  return retiredBlocks;
+}
+
+uint32_t WearLeveling::getBucketCount() {
+  return bucketCount;
+}
+
+void WearLeveling::getBucketRange(uint32_t bucket, uint32_t &from,
+                                  uint32_t &to) {
+  if (bucket == 0) {
+    from = 0;
+    to = 0;
+  }
+  else {
+    from = 1u << (bucket - 1);
+    to = (from << 1) - 1;
+  }
+}
+
+void WearLeveling::getHistogram(std::vector<uint64_t> &values) {
+  values.assign(bucketCount, 0);
+
+  for (auto &iter : eraseCounts) {
+    uint32_t bucket = getBucketIndex(iter.first);
+
+    values.at(MIN(bucket, bucketCount - 1)) += iter.second;
+  }
+}
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FTL_COMMON_WEAR_LEVELING__
+#define __FTL_COMMON_WEAR_LEVELING__
+
+#include <cinttypes>
+#include <map>
+#include <vector>
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+/**
+ * Erase count distribution of physical blocks (static wear-leveling)
+ *
+ * Blocks holding cold data are rarely erased, while GC keeps recycling the
+ * others. When spread of erase counts exceeds threshold, valid data of the
+ * least erased block should be moved to a worn block. Check is done at most
+ * once per interval erases, which bounds migration cost.
+ */
+class WearLeveling {
+ private:
+  const uint32_t threshold;  //!< Max spread of erase counts, 0 to disable
+  const uint32_t interval;   //!< Min # erases between two checks
+  const uint32_t bucketCount;
+
+  std::map<uint32_t, uint32_t> eraseCounts;  //!< Erase count -> # blocks
+  uint64_t erasesSinceCheck;
+  uint64_t retiredBlocks;
+
+ public:
+  WearLeveling(uint32_t, uint32_t, uint32_t, uint64_t);
+  ~WearLeveling();
+
+  void erase(uint32_t, bool);
+  bool isTriggered();
+  bool isCold(uint32_t);
+
+  uint32_t getMinEraseCount();
+  uint32_t getMaxEraseCount();
+  uint64_t getRetiredBlockCount();
+
+  uint32_t getBucketCount();
+  void getBucketRange(uint32_t, uint32_t &, uint32_t &);
+  void getHistogram(std::vector<uint64_t> &);
+};
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
+
+#endif
@@ -34,8 +34,28 @@ const char NAME_GC_MODE[] = "GCMode";
 const char NAME_GC_RECLAIM_BLOCK[] = "GCReclaimBlocks";
 const char NAME_GC_RECLAIM_THRESHOLD[] = "GCReclaimThreshold";
 const char NAME_GC_EVICT_POLICY[] = "EvictPolicy";
+const char NAME_FIRMWARE_CORE[] = "FirmwareCore";
+const char NAME_MAP_LOOKUP_LATENCY[] = "MapLookupLatency";
+const char NAME_MAP_UPDATE_LATENCY[] = "MapUpdateLatency";
+const char NAME_GC_LATENCY[] = "GCLatency";
+const char NAME_CACHE_LOOKUP_LATENCY[] = "CacheLookupLatency";
+// Deprecated, read as MapLookup/MapUpdateLatency and FirmwareCore
 const char NAME_LATENCY[] = "Latency";
 const char NAME_REQUEST_QUEUE[] = "RequestQueue";
+const char NAME_GC_BG_LOW_WATERMARK[] = "GCBackgroundLowWatermark";
+const char NAME_GC_BG_HIGH_WATERMARK[] = "GCBackgroundHighWatermark";
+const char NAME_GC_MAX_PAGES_PER_REQUEST[] = "GCMaxPagesPerRequest";
+const char NAME_USE_COPYBACK[] = "UseCopyback";
+const char NAME_WRITE_STREAM[] = "WriteStreams";
+const char NAME_PRECONDITION_OVERWRITE[] = "PreconditionOverwrite";
+const char NAME_DFTL_CACHE_SIZE[] = "DFTLCacheSize";
+const char NAME_EXTENT_MAPPING[] = "ExtentMapping";
+const char NAME_SLC_CACHE_RATIO[] = "SLCCacheRatio";
+const char NAME_DYNAMIC_ALLOCATION[] = "DynamicAllocation";
+const char NAME_WL_THRESHOLD[] = "WearLevelingThreshold";
+const char NAME_WL_INTERVAL[] = "WearLevelingInterval";
+const char NAME_NKMAP_N[] = "NKMapN";
+const char NAME_NKMAP_K[] = "NKMapK";
 
 Config::Config() {
   mapping = PAGE_MAPPING;
@@ -46,8 +66,26 @@ Config::Config() {
   reclaimBlock = 1;
   reclaimThreshold = 0.1f;
   gcMode = GC_MODE_0;
-  latency = 50000000;
-  requestQueue = 1;
+  evictPolicy = POLICY_GREEDY;
+  firmwareCore = 1;
+  mapLookupLatency = 50000000;
+  mapUpdateLatency = 50000000;
+  gcLatency = 0;
+  cacheLookupLatency = 0;
+  bgLowWatermark = 0.1f;
+  bgHighWatermark = 0.15f;
+  gcMaxPages = 0;
+  useCopyback = false;
+  writeStream = 1;
+  preconditionOverwrite = 0.f;
+  dftlCacheSize = 4194304;
+  extentMapping = false;
+  slcCacheRatio = 0.f;
+  dynamicAllocation = false;
+  wlThreshold = 0;
+  wlInterval = 64;
+  nkMapN = 32;
+  nkMapK = 4;
 }
 
 bool Config::setConfig(const char *name, const char *value) {
@@ -80,11 +118,74 @@ bool Config::setConfig(const char *name, const char *value) {
   else if (MATCH_NAME(NAME_GC_EVICT_POLICY)) {
     evictPolicy = (EVICT_POLICY)strtoul(value, nullptr, 10);
   }
+  else if (MATCH_NAME(NAME_FIRMWARE_CORE)) {
+    firmwareCore = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_MAP_LOOKUP_LATENCY)) {
+    mapLookupLatency = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_MAP_UPDATE_LATENCY)) {
+    mapUpdateLatency = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_GC_LATENCY)) {
+    gcLatency = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_CACHE_LOOKUP_LATENCY)) {
+    cacheLookupLatency = strtoul(value, nullptr, 10);
+  }
   else if (MATCH_NAME(NAME_LATENCY)) {
-    latency = strtoul(value, nullptr, 10);
+    Logger::warn("Latency is deprecated. Use MapLookupLatency and "
+                 "MapUpdateLatency");
+
+    mapLookupLatency = strtoul(value, nullptr, 10);
+    mapUpdateLatency = mapLookupLatency;
   }
   else if (MATCH_NAME(NAME_REQUEST_QUEUE)) {
-    requestQueue = strtoul(value, nullptr, 10);
+    Logger::warn("RequestQueue is deprecated. Use FirmwareCore");
+
+    firmwareCore = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_GC_BG_LOW_WATERMARK)) {
+    bgLowWatermark = strtof(value, nullptr);
+  }
+  else if (MATCH_NAME(NAME_GC_BG_HIGH_WATERMARK)) {
+    bgHighWatermark = strtof(value, nullptr);
+  }
+  else if (MATCH_NAME(NAME_GC_MAX_PAGES_PER_REQUEST)) {
+    gcMaxPages = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_USE_COPYBACK)) {
+    useCopyback = convertBool(value);
+  }
+  else if (MATCH_NAME(NAME_WRITE_STREAM)) {
+    writeStream = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_PRECONDITION_OVERWRITE)) {
+    preconditionOverwrite = strtof(value, nullptr);
+  }
+  else if (MATCH_NAME(NAME_DFTL_CACHE_SIZE)) {
+    dftlCacheSize = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_EXTENT_MAPPING)) {
+    extentMapping = convertBool(value);
+  }
+  else if (MATCH_NAME(NAME_SLC_CACHE_RATIO)) {
+    slcCacheRatio = strtof(value, nullptr);
+  }
+  else if (MATCH_NAME(NAME_DYNAMIC_ALLOCATION)) {
+    dynamicAllocation = convertBool(value);
+  }
+  else if (MATCH_NAME(NAME_WL_THRESHOLD)) {
+    wlThreshold = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_WL_INTERVAL)) {
+    wlInterval = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_NKMAP_N)) {
+    nkMapN = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_NKMAP_K)) {
+    nkMapK = strtoul(value, nullptr, 10);
   }
   else {
     ret = false;
@@ -101,6 +202,44 @@ void Config::update() {
   if (reclaimThreshold < gcThreshold) {
     Logger::panic("Invalid GCReclaimThreshold");
   }
+
+  if (firmwareCore == 0) {
+    Logger::panic("Invalid FirmwareCore");
+  }
+
+  if (writeStream == 0 || writeStream > 8) {
+    Logger::panic("Invalid WriteStreams");
+  }
+
+  if (preconditionOverwrite < 0.f) {
+    Logger::panic("Invalid PreconditionOverwrite");
+  }
+
+  if (slcCacheRatio < 0.f || slcCacheRatio >= 1.f) {
+    Logger::panic("Invalid SLCCacheRatio");
+  }
+
+  if (wlInterval == 0) {
+    Logger::panic("Invalid WearLevelingInterval");
+  }
+
+  if (nkMapN == 0) {
+    Logger::panic("Invalid NKMapN");
+  }
+
+  if (nkMapK == 0) {
+    Logger::panic("Invalid NKMapK");
+  }
+
+  if (gcMode == GC_MODE_2) {
+    if (bgLowWatermark < gcThreshold) {
+      Logger::panic("Invalid GCBackgroundLowWatermark");
+    }
+
+    if (bgHighWatermark < bgLowWatermark || bgHighWatermark >= 1.f) {
+      Logger::panic("Invalid GCBackgroundHighWatermark");
+    }
+  }
 }
 
 int64_t Config::readInt(uint32_t idx) {
@@ -131,11 +270,41 @@ uint64_t Config::readUint(uint32_t idx) {
     case FTL_GC_RECLAIM_BLOCK:
       ret = reclaimBlock;
       break;
-    case FTL_LATENCY:
-      ret = latency;
+    case FTL_FIRMWARE_CORE:
+      ret = firmwareCore;
+      break;
+    case FTL_MAP_LOOKUP_LATENCY:
+      ret = mapLookupLatency;
+      break;
+    case FTL_MAP_UPDATE_LATENCY:
+      ret = mapUpdateLatency;
+      break;
+    case FTL_GC_LATENCY:
+      ret = gcLatency;
+      break;
+    case FTL_CACHE_LOOKUP_LATENCY:
+      ret = cacheLookupLatency;
+      break;
+    case FTL_GC_MAX_PAGES_PER_REQUEST:
+      ret = gcMaxPages;
+      break;
+    case FTL_WRITE_STREAM:
+      ret = writeStream;
+      break;
+    case FTL_DFTL_CACHE_SIZE:
+      ret = dftlCacheSize;
+      break;
+    case FTL_WL_THRESHOLD:
+      ret = wlThreshold;
+      break;
+    case FTL_WL_INTERVAL:
+      ret = wlInterval;
       break;
-    case FTL_REQUEST_QUEUE:
-      ret = requestQueue;
+    case FTL_NKMAP_N:
+      ret = nkMapN;
+      break;
+    case FTL_NKMAP_K:
+      ret = nkMapK;
       break;
   }
 
@@ -158,6 +327,36 @@ float Config::readFloat(uint32_t idx) {
     case FTL_GC_RECLAIM_THRESHOLD:
       ret = reclaimThreshold;
       break;
+    case FTL_GC_BG_LOW_WATERMARK:
+      ret = bgLowWatermark;
+      break;
+    case FTL_GC_BG_HIGH_WATERMARK:
+      ret = bgHighWatermark;
+      break;
+    case FTL_PRECONDITION_OVERWRITE:
+      ret = preconditionOverwrite;
+      break;
+    case FTL_SLC_CACHE_RATIO:
+      ret = slcCacheRatio;
+      break;
+  }
+
+  return ret;
+}
+
+bool Config::readBoolean(uint32_t idx) {
+  bool ret = false;
+
+  switch (idx) {
+    case FTL_USE_COPYBACK:
+      ret = useCopyback;
+      break;
+    case FTL_EXTENT_MAPPING:
+      ret = extentMapping;
+      break;
+    case FTL_DYNAMIC_ALLOCATION:
+      ret = dynamicAllocation;
+      break;
   }
 
   return ret;
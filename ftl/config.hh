@@ -37,8 +37,23 @@ typedef enum {
   FTL_GC_RECLAIM_BLOCK,
   FTL_GC_RECLAIM_THRESHOLD,
   FTL_GC_EVICT_POLICY,
-  FTL_LATENCY,
-  FTL_REQUEST_QUEUE,
+  FTL_FIRMWARE_CORE,
+  FTL_MAP_LOOKUP_LATENCY,
+  FTL_MAP_UPDATE_LATENCY,
+  FTL_GC_LATENCY,
+  FTL_CACHE_LOOKUP_LATENCY,
+  FTL_GC_BG_LOW_WATERMARK,
+  FTL_GC_BG_HIGH_WATERMARK,
+  FTL_GC_MAX_PAGES_PER_REQUEST,
+  FTL_USE_COPYBACK,
+  FTL_WRITE_STREAM,
+  FTL_PRECONDITION_OVERWRITE,
+  FTL_DFTL_CACHE_SIZE,
+  FTL_EXTENT_MAPPING,
+  FTL_SLC_CACHE_RATIO,
+  FTL_DYNAMIC_ALLOCATION,
+  FTL_WL_THRESHOLD,
+  FTL_WL_INTERVAL,
 
   /* N+K Mapping configuration*/
   FTL_NKMAP_N,
@@ -47,11 +62,14 @@ typedef enum {
 
 typedef enum {
   PAGE_MAPPING,
+  DFTL_MAPPING,
+  NK_MAPPING,
 } MAPPING;
 
 typedef enum {
   GC_MODE_0,
   GC_MODE_1,
+  GC_MODE_2,
 } GC_MODE;
 
 typedef enum {
@@ -61,17 +79,34 @@ typedef enum {
 
 class Config : public BaseConfig {
  private:
-  MAPPING mapping;             //!< Default: PAGE_MAPPING
-  float overProvision;         //!< Default: 0.25 (25%)
-  float gcThreshold;           //!< Default: 0.05 (5%)
-  uint64_t badBlockThreshold;  //!< Default: 100000
-  float warmup;                //!< Default: 1.0 (100%)
-  uint64_t reclaimBlock;       //!< Default: 1
-  float reclaimThreshold;      //!< Default: 0.1 (10%)
-  GC_MODE gcMode;              //!< Default: FTL_GC_MODE_0
-  EVICT_POLICY evictPolicy;    //!< Default: POLICY_GREEDY
-  uint64_t latency;            //!< Default: 50us
-  uint64_t requestQueue;       //!< Default: 1
+  MAPPING mapping;              //!< Default: PAGE_MAPPING
+  float overProvision;          //!< Default: 0.25 (25%)
+  float gcThreshold;            //!< Default: 0.05 (5%)
+  uint64_t badBlockThreshold;   //!< Default: 100000
+  float warmup;                 //!< Default: 1.0 (100%)
+  uint64_t reclaimBlock;        //!< Default: 1
+  float reclaimThreshold;       //!< Default: 0.1 (10%)
+  GC_MODE gcMode;               //!< Default: FTL_GC_MODE_0
+  EVICT_POLICY evictPolicy;     //!< Default: POLICY_GREEDY
+  uint64_t firmwareCore;        //!< Default: 1
+  uint64_t mapLookupLatency;    //!< Default: 50us
+  uint64_t mapUpdateLatency;    //!< Default: 50us
+  uint64_t gcLatency;           //!< Default: 0
+  uint64_t cacheLookupLatency;  //!< Default: 0
+  float bgLowWatermark;         //!< Default: 0.1 (10%)
+  float bgHighWatermark;        //!< Default: 0.15 (15%)
+  uint64_t gcMaxPages;          //!< Default: 0 (Unlimited)
+  bool useCopyback;             //!< Default: false
+  uint64_t writeStream;         //!< Default: 1
+  float preconditionOverwrite;  //!< Default: 0 (Disabled)
+  uint64_t dftlCacheSize;       //!< Default: 4MB
+  bool extentMapping;           //!< Default: false
+  float slcCacheRatio;          //!< Default: 0 (Disabled)
+  bool dynamicAllocation;       //!< Default: false
+  uint64_t wlThreshold;         //!< Default: 0 (Disabled)
+  uint64_t wlInterval;          //!< Default: 64
+  uint64_t nkMapN;              //!< Default: 32
+  uint64_t nkMapK;              //!< Default: 4
 
  public:
   Config();
@@ -82,6 +117,7 @@ class Config : public BaseConfig {
   int64_t readInt(uint32_t) override;
   uint64_t readUint(uint32_t) override;
   float readFloat(uint32_t) override;
+  bool readBoolean(uint32_t) override;
 };
 
 }  // namespace FTL
@@ -19,6 +19,8 @@
 
 #include "ftl/ftl.hh"
 
+#include "ftl/common/firmware.hh"
+#include "ftl/nk_mapping.hh"
 #include "ftl/page_mapping.hh"
 #include "log/trace.hh"
 
@@ -26,7 +28,7 @@ namespace SimpleSSD {
 
 namespace FTL {
 
-FTL::FTL(ConfigReader *c) : pConf(c) {
+FTL::FTL(ConfigReader *c, DRAM::AbstractDRAM *d) : pDRAM(d), pConf(c) {
   PAL::Parameter *palparam;
 
   pPAL = new PAL::PAL(pConf);
@@ -41,9 +43,15 @@ FTL::FTL(ConfigReader *c) : pConf(c) {
   param.ioUnitInPage = palparam->pageInSuperPage;
   param.pageCountToMaxPerf = palparam->superBlock / palparam->block;
 
+  pFirmware = new Firmware(pConf->ftlConfig);
+
   switch (pConf->ftlConfig.readInt(FTL_MAPPING_MODE)) {
     case PAGE_MAPPING:
-      pFTL = new PageMapping(&param, pPAL, pConf);
+    case DFTL_MAPPING:
+      pFTL = new PageMapping(&param, pPAL, pDRAM, pFirmware, pConf);
+      break;
+    case NK_MAPPING:
+      pFTL = new NKMapping(&param, pPAL, pFirmware, pConf);
       break;
   }
 
@@ -66,6 +74,7 @@ FTL::FTL(ConfigReader *c) : pConf(c) {
 FTL::~FTL() {
   delete pPAL;
   delete pFTL;
+  delete pFirmware;
 }
 
 void FTL::read(Request &req, uint64_t &tick) {
@@ -80,12 +89,32 @@ void FTL::write(Request &req, uint64_t &tick) {
   pFTL->write(req, tick);
 }
 
+void FTL::read(std::vector<Request> &list, uint64_t &tick) {
+  Logger::debugprint(Logger::LOG_FTL, "READ  | %zu LPNs", list.size());
+
+  pFTL->read(list, tick);
+}
+
+void FTL::write(std::vector<Request> &list, std::vector<uint64_t> &finishedAt,
+                uint64_t &tick) {
+  Logger::debugprint(Logger::LOG_FTL, "WRITE | %zu LPNs", list.size());
+
+  pFTL->write(list, finishedAt, tick);
+}
+
 void FTL::trim(Request &req, uint64_t &tick) {
   Logger::debugprint(Logger::LOG_FTL, "TRIM  | LPN %" PRIu64, req.lpn);
 
   pFTL->trim(req, tick);
 }
 
+void FTL::trim(LPNRange &range, uint64_t &tick) {
+  Logger::debugprint(Logger::LOG_FTL, "TRIM  | LPN %" PRIu64 " + %" PRIu64,
+                     range.slpn, range.nlp);
+
+  pFTL->trim(range, tick);
+}
+
 void FTL::format(LPNRange &range, uint64_t &tick) {
   pFTL->format(range, tick);
 }
@@ -94,22 +123,29 @@ Parameter *FTL::getInfo() {
   return &param;
 }
 
+Firmware *FTL::getFirmware() {
+  return pFirmware;
+}
+
 uint64_t FTL::getUsedPageCount() {
   return pFTL->getStatus()->mappedLogicalPages;
 }
 
 void FTL::getStats(std::vector<Stats> &list) {
   pFTL->getStats(list);
+  pFirmware->getStats(list);
   pPAL->getStats(list);
 }
 
 void FTL::getStatValues(std::vector<uint64_t> &values) {
   pFTL->getStatValues(values);
+  pFirmware->getStatValues(values);
   pPAL->getStatValues(values);
 }
 
 void FTL::resetStats() {
   pFTL->resetStats();
+  pFirmware->resetStats();
   pPAL->resetStats();
 }
 
@@ -20,6 +20,7 @@
 #ifndef __FTL_FTL__
 #define __FTL_FTL__
 
+#include "dram/abstract_dram.hh"
 #include "pal/pal.hh"
 #include "util/config.hh"
 #include "util/def.hh"
@@ -29,6 +30,7 @@ namespace SimpleSSD {
 namespace FTL {
 
 class AbstractFTL;
+class Firmware;
 
 typedef struct {
   uint64_t totalPhysicalBlocks;  //!< (PAL::Parameter::superBlock)
@@ -43,21 +45,27 @@ class FTL : public StatObject {
  private:
   Parameter param;
   PAL::PAL *pPAL;
+  DRAM::AbstractDRAM *pDRAM;
 
   ConfigReader *pConf;
+  Firmware *pFirmware;
   AbstractFTL *pFTL;
 
  public:
-  FTL(ConfigReader *);
+  FTL(ConfigReader *, DRAM::AbstractDRAM *);
   ~FTL();
 
   void read(Request &, uint64_t &);
   void write(Request &, uint64_t &);
+  void read(std::vector<Request> &, uint64_t &);
+  void write(std::vector<Request> &, std::vector<uint64_t> &, uint64_t &);
   void trim(Request &, uint64_t &);
+  void trim(LPNRange &, uint64_t &);
 
   void format(LPNRange &, uint64_t &);
 
   Parameter *getInfo();
+  Firmware *getFirmware();
   uint64_t getUsedPageCount();
 
   void getStats(std::vector<Stats> &) override;
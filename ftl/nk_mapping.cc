@@ -0,0 +1,611 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ftl/nk_mapping.hh"
+
+#include <algorithm>
+
+#include "log/trace.hh"
+#include "util/algorithm.hh"
+
+#define UNMAPPED 0xFFFFFFFF
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+NKMapping::NKMapping(Parameter *p, PAL::PAL *l, Firmware *f, ConfigReader *c)
+    : AbstractFTL(p, l),
+      pPAL(l),
+      pFirmware(f),
+      conf(c->ftlConfig),
+      pFTLParam(p),
+      nDataBlock(conf.readUint(FTL_NKMAP_N)),
+      nLogBlock(conf.readUint(FTL_NKMAP_K)),
+      dataBlock(pFTLParam->totalLogicalBlocks, UNMAPPED),
+      logBlock((pFTLParam->totalLogicalBlocks - 1) / nDataBlock + 1),
+      sequentialOwner(pFTLParam->totalPhysicalBlocks, UNMAPPED),
+      mappedPages(0) {
+  blocks.reserve(pFTLParam->totalPhysicalBlocks);
+
+  for (uint32_t i = 0; i < pFTLParam->totalPhysicalBlocks; i++) {
+    blocks.emplace_back(pFTLParam->pagesInBlock, pFTLParam->ioUnitInPage);
+    freeBlocks.push_back(i);
+  }
+
+  status.totalLogicalPages =
+      pFTLParam->totalLogicalBlocks * pFTLParam->pagesInBlock;
+
+  // All groups may hold K log blocks, and full merge needs one more block
+  if (pFTLParam->totalPhysicalBlocks <=
+      pFTLParam->totalLogicalBlocks + logBlock.size() * nLogBlock + 1) {
+    Logger::panic("Too many log blocks for over-provisioned blocks");
+  }
+
+  memset(&stat, 0, sizeof(stat));
+
+  Logger::debugprint(
+      Logger::LOG_FTL_NK_MAPPING,
+      "CREATE | N %u | K %u | %zu groups | Mapping table %" PRIu64 " bytes",
+      nDataBlock, nLogBlock, logBlock.size(), getTableSize());
+}
+
+NKMapping::~NKMapping() {}
+
+// One entry per logical block, and one entry per page of log blocks
+uint64_t NKMapping::getTableSize() {
+  return (uint64_t)dataBlock.size() * sizeof(uint32_t) +
+         (uint64_t)logBlock.size() * nLogBlock * pFTLParam->pagesInBlock *
+             sizeof(uint32_t);
+}
+
+bool NKMapping::initialize() {
+  uint64_t nPagesToWarmup;
+  uint64_t nTotalPages;
+
+  nTotalPages = pFTLParam->totalLogicalBlocks * pFTLParam->pagesInBlock;
+  nPagesToWarmup = nTotalPages * conf.readFloat(FTL_WARM_UP_RATIO);
+  nPagesToWarmup = MIN(nPagesToWarmup, nTotalPages);
+
+  // Warm-up writes are sequential, so fill data blocks directly
+  for (uint64_t lpn = 0; lpn < nPagesToWarmup; lpn++) {
+    uint32_t &blockIndex = dataBlock.at(lpn / pFTLParam->pagesInBlock);
+
+    if (blockIndex == UNMAPPED) {
+      blockIndex = getFreeBlock();
+    }
+
+    blocks.at(blockIndex).writePage(lpn % pFTLParam->pagesInBlock, lpn, 0);
+  }
+
+  mappedPages = nPagesToWarmup;
+
+  Logger::debugprint(Logger::LOG_FTL_NK_MAPPING,
+                     "INIT | Warm-up %" PRIu64 " pages", nPagesToWarmup);
+
+  return true;
+}
+
+void NKMapping::read(Request &req, uint64_t &tick) {
+  PAL::Request palRequest(req);
+  uint64_t begin = tick;
+  uint32_t blockIndex;
+  uint32_t pageIndex;
+
+  if (getLatestPage(req.lpn, blockIndex, pageIndex)) {
+    pFirmware->execute(FIRMWARE_MAP_LOOKUP, req.ioFlag.count(), tick);
+
+    palRequest.blockIndex = blockIndex;
+    palRequest.pageIndex = pageIndex;
+
+    pPAL->read(palRequest, tick);
+  }
+
+  Logger::debugprint(Logger::LOG_FTL_NK_MAPPING,
+                     "READ  | LPN %" PRIu64 " | %" PRIu64 " - %" PRIu64
+                     " (%" PRIu64 ")",
+                     req.lpn, begin, tick, tick - begin);
+}
+
+void NKMapping::write(Request &req, uint64_t &tick) {
+  PAL::Request palRequest(req);
+  uint64_t begin = tick;
+  uint32_t lbn = req.lpn / pFTLParam->pagesInBlock;
+  uint32_t offset = req.lpn % pFTLParam->pagesInBlock;
+  uint32_t blockIndex;
+  uint32_t pageIndex;
+
+  if (lbn >= dataBlock.size()) {
+    Logger::panic("LPN out of range");
+  }
+
+  pFirmware->execute(FIRMWARE_MAP_UPDATE, req.ioFlag.count(), tick);
+
+  // May merge log blocks, which moves the current copy of this LPN
+  uint32_t logIndex = getLogBlock(lbn / nDataBlock, tick);
+  Block &block = blocks.at(logIndex);
+  uint32_t newPageIndex = block.getNextWritePageIndex();
+
+  palRequest.ioFlag.set();
+
+  if (getLatestPage(req.lpn, blockIndex, pageIndex)) {
+    // Log blocks are page mapped, so partial write needs rest of the page
+    if (!req.ioFlag.all()) {
+      palRequest.blockIndex = blockIndex;
+      palRequest.pageIndex = pageIndex;
+
+      pPAL->read(palRequest, tick);
+    }
+
+    invalidatePage(blockIndex, pageIndex);
+  }
+  else {
+    mappedPages++;
+  }
+
+  // Check log block is still written in order of one logical block
+  uint32_t &owner = sequentialOwner.at(logIndex);
+
+  if (newPageIndex == 0) {
+    owner = offset == 0 ? lbn : UNMAPPED;
+  }
+  else if (owner != lbn || offset != newPageIndex) {
+    owner = UNMAPPED;
+  }
+
+  block.writePage(newPageIndex, req.lpn, tick);
+  logMapping[req.lpn] = std::make_pair(logIndex, newPageIndex);
+
+  palRequest.blockIndex = logIndex;
+  palRequest.pageIndex = newPageIndex;
+
+  pPAL->write(palRequest, tick);
+
+  Logger::debugprint(Logger::LOG_FTL_NK_MAPPING,
+                     "WRITE | LPN %" PRIu64 " | %" PRIu64 " - %" PRIu64
+                     " (%" PRIu64 ")",
+                     req.lpn, begin, tick, tick - begin);
+}
+
+void NKMapping::read(std::vector<Request> &list, uint64_t &tick) {
+  uint64_t finishedAt = tick;
+
+  for (auto &req : list) {
+    uint64_t beginAt = tick;
+
+    read(req, beginAt);
+
+    finishedAt = MAX(finishedAt, beginAt);
+  }
+
+  tick = finishedAt;
+}
+
+void NKMapping::write(std::vector<Request> &list,
+                      std::vector<uint64_t> &finishedList, uint64_t &tick) {
+  uint64_t finishedAt = tick;
+
+  finishedList.clear();
+
+  // Log block merge of one request may move pages of others, so requests
+  // are not merged into one PAL request here
+  for (auto &req : list) {
+    uint64_t beginAt = tick;
+
+    write(req, beginAt);
+
+    finishedList.push_back(beginAt);
+    finishedAt = MAX(finishedAt, beginAt);
+  }
+
+  tick = finishedAt;
+}
+
+void NKMapping::trim(Request &req, uint64_t &tick) {
+  uint32_t blockIndex;
+  uint32_t pageIndex;
+
+  if (getLatestPage(req.lpn, blockIndex, pageIndex)) {
+    invalidatePage(blockIndex, pageIndex);
+    logMapping.erase(req.lpn);
+    mappedPages--;
+  }
+
+  Logger::debugprint(Logger::LOG_FTL_NK_MAPPING,
+                     "TRIM  | LPN %" PRIu64 " | %" PRIu64, req.lpn, tick);
+}
+
+void NKMapping::trim(LPNRange &range, uint64_t &tick) {
+  uint64_t end = MIN(range.slpn + range.nlp, status.totalLogicalPages);
+  Request req(pFTLParam->ioUnitInPage);
+
+  for (req.lpn = range.slpn; req.lpn < end; req.lpn++) {
+    trim(req, tick);
+  }
+}
+
+void NKMapping::format(LPNRange &range, uint64_t &tick) {
+  uint64_t end = MIN(range.slpn + range.nlp, status.totalLogicalPages);
+  uint64_t finishedAt = tick;
+  Request req(pFTLParam->ioUnitInPage);
+
+  if (range.slpn >= end) {
+    return;
+  }
+
+  for (req.lpn = range.slpn; req.lpn < end; req.lpn++) {
+    trim(req, tick);
+  }
+
+  // Erase data blocks and log blocks left without valid page
+  uint32_t firstLBN = range.slpn / pFTLParam->pagesInBlock;
+  uint32_t lastLBN = (end - 1) / pFTLParam->pagesInBlock;
+
+  for (uint32_t lbn = firstLBN; lbn <= lastLBN; lbn++) {
+    uint32_t &blockIndex = dataBlock.at(lbn);
+
+    if (blockIndex != UNMAPPED &&
+        blocks.at(blockIndex).getValidPageCount() == 0) {
+      uint64_t beginAt = tick;
+
+      eraseBlock(blockIndex, beginAt);
+      blockIndex = UNMAPPED;
+
+      finishedAt = MAX(finishedAt, beginAt);
+    }
+  }
+
+  for (uint32_t group = firstLBN / nDataBlock; group <= lastLBN / nDataBlock;
+       group++) {
+    auto &list = logBlock.at(group);
+
+    for (auto iter = list.begin(); iter != list.end();) {
+      if (blocks.at(*iter).getValidPageCount() == 0) {
+        uint64_t beginAt = tick;
+
+        eraseBlock(*iter, beginAt);
+        iter = list.erase(iter);
+
+        finishedAt = MAX(finishedAt, beginAt);
+      }
+      else {
+        ++iter;
+      }
+    }
+  }
+
+  tick = finishedAt;
+}
+
+Status *NKMapping::getStatus() {
+  status.freePhysicalBlocks = freeBlocks.size();
+  status.mappedLogicalPages = mappedPages;
+
+  return &status;
+}
+
+uint32_t NKMapping::getFreeBlock() {
+  if (freeBlocks.size() == 0) {
+    Logger::panic("No free block left");
+  }
+
+  uint32_t blockIndex = freeBlocks.front();
+
+  freeBlocks.pop_front();
+
+  return blockIndex;
+}
+
+uint32_t NKMapping::getLogBlock(uint32_t group, uint64_t &tick) {
+  auto &list = logBlock.at(group);
+
+  if (list.size() > 0 && blocks.at(list.back()).getNextWritePageIndex() <
+                             pFTLParam->pagesInBlock) {
+    return list.back();
+  }
+
+  if (list.size() >= nLogBlock) {
+    mergeGroup(group, tick);
+  }
+
+  uint32_t blockIndex = getFreeBlock();
+
+  list.push_back(blockIndex);
+
+  return blockIndex;
+}
+
+bool NKMapping::getLatestPage(uint64_t lpn, uint32_t &blockIndex,
+                              uint32_t &pageIndex) {
+  auto iter = logMapping.find(lpn);
+
+  if (iter != logMapping.end()) {
+    blockIndex = iter->second.first;
+    pageIndex = iter->second.second;
+
+    return true;
+  }
+
+  blockIndex = dataBlock.at(lpn / pFTLParam->pagesInBlock);
+  pageIndex = lpn % pFTLParam->pagesInBlock;
+
+  return blockIndex != UNMAPPED && blocks.at(blockIndex).isValid(pageIndex);
+}
+
+void NKMapping::invalidatePage(uint32_t blockIndex, uint32_t pageIndex) {
+  Block &block = blocks.at(blockIndex);
+
+  for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
+    block.invalidate(pageIndex, idx);
+  }
+}
+
+void NKMapping::copyPage(uint64_t lpn, uint32_t dstBlockIndex, uint64_t tick,
+                         uint64_t &finishedAt) {
+  PAL::Request req(pFTLParam->ioUnitInPage);
+  uint32_t blockIndex;
+  uint32_t pageIndex;
+
+  if (!getLatestPage(lpn, blockIndex, pageIndex)) {
+    return;
+  }
+
+  req.blockIndex = blockIndex;
+  req.pageIndex = pageIndex;
+  req.ioFlag.set();
+
+  pPAL->read(req, tick);
+
+  invalidatePage(blockIndex, pageIndex);
+  logMapping.erase(lpn);
+
+  // Data blocks keep pages at their offset
+  req.blockIndex = dstBlockIndex;
+  req.pageIndex = lpn % pFTLParam->pagesInBlock;
+
+  blocks.at(dstBlockIndex).writePage(req.pageIndex, lpn, tick);
+  pPAL->write(req, tick);
+
+  finishedAt = MAX(finishedAt, tick);
+  stat.copiedPages++;
+}
+
+void NKMapping::eraseBlock(uint32_t blockIndex, uint64_t &tick) {
+  static uint64_t threshold = conf.readUint(FTL_BAD_BLOCK_THRESHOLD);
+  PAL::Request req(pFTLParam->ioUnitInPage);
+  Block &block = blocks.at(blockIndex);
+
+  if (block.getValidPageCount() != 0) {
+    Logger::panic("There are valid pages in victim block");
+  }
+
+  req.blockIndex = blockIndex;
+  req.pageIndex = 0;
+  req.ioFlag.set();
+
+  block.erase();
+  pPAL->erase(req, tick);
+
+  sequentialOwner.at(blockIndex) = UNMAPPED;
+  stat.erasedBlocks++;
+
+  // Check erase count
+  if (block.getEraseCount() < threshold) {
+    freeBlocks.push_back(blockIndex);
+  }
+}
+
+void NKMapping::switchMerge(uint32_t lbn, uint32_t logIndex, uint64_t &tick) {
+  uint64_t lpn = (uint64_t)lbn * pFTLParam->pagesInBlock;
+  uint32_t oldIndex = dataBlock.at(lbn);
+
+  // Log block holds all pages in order, so it just becomes the data block
+  for (uint32_t page = 0; page < pFTLParam->pagesInBlock; page++) {
+    logMapping.erase(lpn + page);
+  }
+
+  dataBlock.at(lbn) = logIndex;
+  sequentialOwner.at(logIndex) = UNMAPPED;
+
+  if (oldIndex != UNMAPPED) {
+    eraseBlock(oldIndex, tick);
+  }
+
+  stat.switchMerge++;
+}
+
+void NKMapping::partialMerge(uint32_t lbn, uint32_t logIndex, uint64_t &tick) {
+  uint64_t lpn = (uint64_t)lbn * pFTLParam->pagesInBlock;
+  uint32_t written = blocks.at(logIndex).getNextWritePageIndex();
+  uint32_t oldIndex = dataBlock.at(lbn);
+  uint64_t finishedAt = tick;
+
+  for (uint32_t page = 0; page < written; page++) {
+    logMapping.erase(lpn + page);
+  }
+
+  // Fill rest of the log block, then it becomes the data block
+  for (uint32_t page = written; page < pFTLParam->pagesInBlock; page++) {
+    copyPage(lpn + page, logIndex, tick, finishedAt);
+  }
+
+  dataBlock.at(lbn) = logIndex;
+  sequentialOwner.at(logIndex) = UNMAPPED;
+
+  if (oldIndex != UNMAPPED) {
+    eraseBlock(oldIndex, finishedAt);
+  }
+
+  tick = finishedAt;
+  stat.partialMerge++;
+}
+
+void NKMapping::fullMerge(uint32_t lbn, uint64_t &tick) {
+  uint64_t lpn = (uint64_t)lbn * pFTLParam->pagesInBlock;
+  uint32_t oldIndex = dataBlock.at(lbn);
+  uint32_t newIndex = getFreeBlock();
+  uint64_t finishedAt = tick;
+
+  // Collect latest copy of each page to new data block
+  for (uint32_t page = 0; page < pFTLParam->pagesInBlock; page++) {
+    copyPage(lpn + page, newIndex, tick, finishedAt);
+  }
+
+  if (blocks.at(newIndex).getValidPageCount() > 0) {
+    dataBlock.at(lbn) = newIndex;
+  }
+  else {
+    // Nothing to collect, return unused block
+    freeBlocks.push_front(newIndex);
+    dataBlock.at(lbn) = UNMAPPED;
+  }
+
+  if (oldIndex != UNMAPPED) {
+    eraseBlock(oldIndex, finishedAt);
+  }
+
+  tick = finishedAt;
+  stat.fullMerge++;
+}
+
+void NKMapping::mergeGroup(uint32_t group, uint64_t &tick) {
+  auto &list = logBlock.at(group);
+  std::vector<uint32_t> randomLogs;
+  std::vector<uint32_t> lbns;
+  std::vector<uint64_t> lpns;
+  DynamicBitset bitset(pFTLParam->ioUnitInPage);
+  uint64_t begin = tick;
+  uint64_t finishedAt = tick;
+
+  // Merges of different logical blocks are issued together, and PAL
+  // serializes them on shared dies
+  for (auto &logIndex : list) {
+    Block &block = blocks.at(logIndex);
+    uint32_t lbn = sequentialOwner.at(logIndex);
+    uint64_t beginAt = tick;
+
+    if (lbn != UNMAPPED &&
+        block.getValidPageCount() == block.getNextWritePageIndex()) {
+      if (block.getNextWritePageIndex() == pFTLParam->pagesInBlock) {
+        switchMerge(lbn, logIndex, beginAt);
+      }
+      else {
+        partialMerge(lbn, logIndex, beginAt);
+      }
+
+      finishedAt = MAX(finishedAt, beginAt);
+    }
+    else {
+      randomLogs.push_back(logIndex);
+    }
+  }
+
+  // Logical blocks with valid pages in remaining log blocks
+  for (auto &logIndex : randomLogs) {
+    Block &block = blocks.at(logIndex);
+
+    for (uint32_t page = 0; page < block.getNextWritePageIndex(); page++) {
+      if (block.getPageInfo(page, lpns, bitset)) {
+        lbns.push_back(lpns.front() / pFTLParam->pagesInBlock);
+      }
+    }
+  }
+
+  std::sort(lbns.begin(), lbns.end());
+  lbns.erase(std::unique(lbns.begin(), lbns.end()), lbns.end());
+
+  for (auto &lbn : lbns) {
+    uint64_t beginAt = tick;
+
+    fullMerge(lbn, beginAt);
+
+    finishedAt = MAX(finishedAt, beginAt);
+  }
+
+  // Erase log blocks after all valid pages are moved
+  tick = finishedAt;
+
+  for (auto &logIndex : randomLogs) {
+    uint64_t beginAt = tick;
+
+    eraseBlock(logIndex, beginAt);
+
+    finishedAt = MAX(finishedAt, beginAt);
+  }
+
+  list.clear();
+
+  tick = finishedAt;
+  stat.mergeTime += tick - begin;
+
+  Logger::debugprint(Logger::LOG_FTL_NK_MAPPING,
+                     "MERGE | Group %u | %" PRIu64 " - %" PRIu64 " (%" PRIu64
+                     ")",
+                     group, begin, tick, tick - begin);
+}
+
+void NKMapping::getStats(std::vector<Stats> &list) {
+  Stats temp;
+
+  temp.name = "ftl.nk_mapping.switch_merge";
+  temp.desc = "Total switch merge count";
+  list.push_back(temp);
+
+  temp.name = "ftl.nk_mapping.partial_merge";
+  temp.desc = "Total partial merge count";
+  list.push_back(temp);
+
+  temp.name = "ftl.nk_mapping.full_merge";
+  temp.desc = "Total full merge count";
+  list.push_back(temp);
+
+  temp.name = "ftl.nk_mapping.copied_pages";
+  temp.desc = "Total pages copied in merge";
+  list.push_back(temp);
+
+  temp.name = "ftl.nk_mapping.erased_blocks";
+  temp.desc = "Total erased blocks";
+  list.push_back(temp);
+
+  temp.name = "ftl.nk_mapping.merge_time";
+  temp.desc = "Total time spent on merge (ps)";
+  list.push_back(temp);
+
+  temp.name = "ftl.nk_mapping.table_size";
+  temp.desc = "Bytes used by mapping table";
+  list.push_back(temp);
+}
+
+void NKMapping::getStatValues(std::vector<uint64_t> &values) {
+  values.push_back(stat.switchMerge);
+  values.push_back(stat.partialMerge);
+  values.push_back(stat.fullMerge);
+  values.push_back(stat.copiedPages);
+  values.push_back(stat.erasedBlocks);
+  values.push_back(stat.mergeTime);
+  values.push_back(getTableSize());
+}
+
+void NKMapping::resetStats() {
+  memset(&stat, 0, sizeof(stat));
+}
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
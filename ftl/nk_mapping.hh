@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FTL_NK_MAPPING__
+#define __FTL_NK_MAPPING__
+
+#include <cinttypes>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "ftl/abstract_ftl.hh"
+#include "ftl/common/block.hh"
+#include "ftl/common/firmware.hh"
+#include "ftl/ftl.hh"
+#include "pal/pal.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+/**
+ * N+K hybrid mapping
+ *
+ * Logical blocks are mapped to data blocks in block granularity. Every N
+ * logical blocks form a group, which shares at most K page mapped log blocks.
+ * When all log blocks of a group are full, they are merged into data blocks
+ * by switch, partial or full merge.
+ */
+class NKMapping : public AbstractFTL {
+ private:
+  PAL::PAL *pPAL;
+  Firmware *pFirmware;
+
+  Config &conf;
+  Parameter *pFTLParam;
+
+  uint32_t nDataBlock;  //!< N
+  uint32_t nLogBlock;   //!< K
+
+  std::vector<Block> blocks;
+  std::deque<uint32_t> freeBlocks;
+
+  std::vector<uint32_t> dataBlock;  //!< Logical block -> data block
+  std::vector<std::vector<uint32_t>> logBlock;  //!< Group -> log blocks
+  std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> logMapping;
+
+  // Logical block written in order from first page, for each log block
+  std::vector<uint32_t> sequentialOwner;
+
+  uint64_t mappedPages;
+
+  struct {
+    uint64_t switchMerge;
+    uint64_t partialMerge;
+    uint64_t fullMerge;
+    uint64_t copiedPages;
+    uint64_t erasedBlocks;
+    uint64_t mergeTime;
+  } stat;
+
+  uint32_t getFreeBlock();
+  uint64_t getTableSize();
+  uint32_t getLogBlock(uint32_t, uint64_t &);
+  bool getLatestPage(uint64_t, uint32_t &, uint32_t &);
+  void invalidatePage(uint32_t, uint32_t);
+  void copyPage(uint64_t, uint32_t, uint64_t, uint64_t &);
+  void eraseBlock(uint32_t, uint64_t &);
+  void switchMerge(uint32_t, uint32_t, uint64_t &);
+  void partialMerge(uint32_t, uint32_t, uint64_t &);
+  void fullMerge(uint32_t, uint64_t &);
+  void mergeGroup(uint32_t, uint64_t &);
+
+ public:
+  NKMapping(Parameter *, PAL::PAL *, Firmware *, ConfigReader *);
+  ~NKMapping();
+
+  bool initialize() override;
+
+  void read(Request &, uint64_t &) override;
+  void write(Request &, uint64_t &) override;
+  void read(std::vector<Request> &, uint64_t &) override;
+  void write(std::vector<Request> &, std::vector<uint64_t> &,
+             uint64_t &) override;
+  void trim(Request &, uint64_t &) override;
+  void trim(LPNRange &, uint64_t &) override;
+
+  void format(LPNRange &, uint64_t &) override;
+
+  Status *getStatus() override;
+
+  void getStats(std::vector<Stats> &) override;
+  void getStatValues(std::vector<uint64_t> &) override;
+  void resetStats() override;
+};
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
+
+#endif
@@ -20,7 +20,11 @@
 #include "ftl/page_mapping.hh"
 
 #include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <limits>
+#include <random>
+#include <string>
 
 #include "log/trace.hh"
 #include "util/algorithm.hh"
@@ -29,59 +33,286 @@ namespace SimpleSSD {
 
 namespace FTL {
 
-PageMapping::PageMapping(Parameter *p, PAL::PAL *l, ConfigReader *c)
+PageMapping::PageMapping(Parameter *p, PAL::PAL *l, DRAM::AbstractDRAM *d,
+                         Firmware *f, ConfigReader *c)
     : AbstractFTL(p, l),
       pPAL(l),
+      pDRAM(d),
+      pFirmware(f),
       conf(c->ftlConfig),
       pFTLParam(p),
-      latency(conf.readUint(FTL_LATENCY), conf.readUint(FTL_REQUEST_QUEUE)),
-      lastFreeBlock(pFTLParam->pageCountToMaxPerf),
-      bReclaimMore(false) {
+      bExtentMapping(conf.readBoolean(FTL_EXTENT_MAPPING)),
+      bDynamicAllocation(conf.readBoolean(FTL_DYNAMIC_ALLOCATION)),
+      table(pFTLParam->totalLogicalBlocks * pFTLParam->pagesInBlock,
+            pFTLParam->ioUnitInPage, pFTLParam->totalPhysicalBlocks,
+            pFTLParam->pagesInBlock, bExtentMapping,
+            pFTLParam->pageCountToMaxPerf),
+      bDemandMapping(conf.readInt(FTL_MAPPING_MODE) == DFTL_MAPPING),
+      entriesInTranslationPage(pFTLParam->pageSize /
+                               pFTLParam->ioUnitInPage / sizeof(uint32_t)),
+      gtd(bDemandMapping
+              ? (table.getLPNCount() - 1) / entriesInTranslationPage + 1
+              : 0,
+          1, pFTLParam->totalPhysicalBlocks, pFTLParam->pagesInBlock),
+      cmt(bDemandMapping
+              ? conf.readUint(FTL_DFTL_CACHE_SIZE) / pFTLParam->pageSize
+              : 0),
+      freeBlockSlots(pFTLParam->pageCountToMaxPerf),
+      bWearLeveling(conf.readUint(FTL_WL_THRESHOLD) > 0),
+      wlStream(0),
+      wearLeveling(conf.readUint(FTL_WL_THRESHOLD),
+                   conf.readUint(FTL_WL_INTERVAL),
+                   pFTLParam->totalPhysicalBlocks,
+                   conf.readUint(FTL_BAD_BLOCK_THRESHOLD)),
+      streamCount(conf.readUint(FTL_WRITE_STREAM)),
+      lastFreeBlock(pFTLParam->pageCountToMaxPerf *
+                    (streamCount + (bDemandMapping ? 1 : 0) +
+                     (bWearLeveling ? 1 : 0))),
+      lastFreeBlockIndex(
+          streamCount + (bDemandMapping ? 1 : 0) + (bWearLeveling ? 1 : 0), 0),
+      blockStream(pFTLParam->totalPhysicalBlocks, 0),
+      openBlock(pFTLParam->totalPhysicalBlocks, false),
+      updateCount(streamCount > 2 ? table.getLPNCount() : 0, 0),
+      updatesInEpoch(0),
+      victimIndex(pFTLParam->pagesInBlock + 1),
+      bReclaimMore(false),
+      bBackgroundGC(false),
+      lastRequestFinishedAt(0),
+      lastGCFinishedAt(0),
+      bgReclaimLatency(0),
+      gcPageIndex(0),
+      gcFinishedAt(0),
+      gcBusyUntil(0),
+      slcBlocksPerSlot(0),
+      slcBlock(pFTLParam->totalPhysicalBlocks, false),
+      slcFrontierIndex(0),
+      lastFoldFinishedAt(0),
+      foldLatency(0) {
+  float slcRatio = conf.readFloat(FTL_SLC_CACHE_RATIO);
+
+  if (slcRatio > 0.f) {
+    slcBlocksPerSlot = MAX(pFTLParam->totalPhysicalBlocks * slcRatio /
+                               pFTLParam->pageCountToMaxPerf,
+                           1);
+  }
+
+  // Reserve buckets, so iterators remain valid while blocks move around
+  blocks.reserve(pFTLParam->totalPhysicalBlocks);
+  freeBlocks.reserve(pFTLParam->totalPhysicalBlocks);
+
   for (uint32_t i = 0; i < pFTLParam->totalPhysicalBlocks; i++) {
-    freeBlocks.insert(
-        {i, Block(pFTLParam->pagesInBlock, pFTLParam->ioUnitInPage)});
+    freeBlocks.emplace(
+        i, Block(pFTLParam->pagesInBlock, pFTLParam->ioUnitInPage));
+    freeBlockSlots.at(convertBlockIdx(i)).emplace(0, i);
   }
 
   status.totalLogicalPages =
       pFTLParam->totalLogicalBlocks * pFTLParam->pagesInBlock;
 
+  // Each stream keeps one block per slot open
+  if (pFTLParam->totalPhysicalBlocks <=
+      pFTLParam->totalLogicalBlocks +
+          pFTLParam->pageCountToMaxPerf *
+              (lastFreeBlockIndex.size() + slcBlocksPerSlot)) {
+    Logger::panic("Too many write streams for over-provisioned blocks");
+  }
+
+  if (bDemandMapping) {
+    if (pDRAM == nullptr) {
+      Logger::panic("DFTL requires DRAM model");
+    }
+
+    if (cmt.getCapacity() == 0) {
+      Logger::panic("DFTLCacheSize is smaller than one translation page");
+    }
+  }
+
+  if (bWearLeveling) {
+    wlStream = lastFreeBlockIndex.size() - 1;
+  }
+
   // Allocate free blocks
-  for (uint32_t i = 0; i < pFTLParam->pageCountToMaxPerf; i++) {
-    lastFreeBlock.at(i) = getFreeBlock(i);
+  for (uint32_t s = 0; s < lastFreeBlockIndex.size(); s++) {
+    for (uint32_t i = 0; i < pFTLParam->pageCountToMaxPerf; i++) {
+      uint32_t blockIndex = getFreeBlock(i);
+
+      lastFreeBlock.at(s * pFTLParam->pageCountToMaxPerf + i) = blockIndex;
+      blockStream.at(blockIndex) = bWearLeveling && s == wlStream ? 0 : s;
+      openBlock.at(blockIndex) = true;
+    }
   }
 
-  lastFreeBlockIndex = 0;
+  // Reserve pseudo-SLC region
+  if (slcBlocksPerSlot > 0) {
+    uint32_t lsbPages = 0;
+
+    slcNextPage.resize(pFTLParam->pagesInBlock + 1, pFTLParam->pagesInBlock);
+
+    for (uint32_t i = pFTLParam->pagesInBlock; i-- > 0;) {
+      if (pPAL->isLSBPage(i)) {
+        slcNextPage.at(i) = i;
+        lsbPages++;
+      }
+      else {
+        slcNextPage.at(i) = slcNextPage.at(i + 1);
+      }
+    }
+
+    slcFrontier.resize(pFTLParam->pageCountToMaxPerf);
+    slcFreeBlocks.resize(pFTLParam->pageCountToMaxPerf);
+    slcFullBlocks.resize(pFTLParam->pageCountToMaxPerf);
+
+    for (uint32_t i = 0; i < pFTLParam->pageCountToMaxPerf; i++) {
+      for (uint32_t n = 0; n < slcBlocksPerSlot; n++) {
+        uint32_t blockIndex = getFreeBlock(i);
+
+        victimIndex.at(0).erase(blockIndex);
+        blockStream.at(blockIndex) = 0;
+        slcBlock.at(blockIndex) = true;
+        slcFreeBlocks.at(i).push_back(blockIndex);
+      }
+
+      slcFrontier.at(i) = slcFreeBlocks.at(i).front();
+      slcFreeBlocks.at(i).pop_front();
+    }
+
+    Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
+                       "CREATE | SLC cache %u blocks | %u / %u pages per block",
+                       slcBlocksPerSlot * pFTLParam->pageCountToMaxPerf,
+                       lsbPages, pFTLParam->pagesInBlock);
+  }
 
   memset(&stat, 0, sizeof(stat));
+  streamStat.resize(streamCount);
+  memset(streamStat.data(), 0, sizeof(StreamStat) * streamCount);
+
+  Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
+                     "CREATE | Mapping table %" PRIu64 " bytes",
+                     table.getTableSize());
+
+  if (bDemandMapping) {
+    Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
+                       "CREATE | DFTL | %" PRIu64 " LPNs per translation page"
+                       " | %" PRIu64 " / %" PRIu64 " pages cached",
+                       entriesInTranslationPage, cmt.getCapacity(),
+                       gtd.getLPNCount());
+  }
 }
 
 PageMapping::~PageMapping() {}
 
 bool PageMapping::initialize() {
+  static const float threshold = conf.readFloat(FTL_GC_THRESHOLD_RATIO);
   uint64_t nPagesToWarmup;
   uint64_t nTotalPages;
   uint64_t tick;
+  uint64_t lpn;
   Request req(pFTLParam->ioUnitInPage);
+  std::vector<Block *> frontier(pFTLParam->pageCountToMaxPerf);
+  auto begin = std::chrono::steady_clock::now();
 
   nTotalPages = pFTLParam->totalLogicalBlocks * pFTLParam->pagesInBlock;
   nPagesToWarmup = nTotalPages * conf.readFloat(FTL_WARM_UP_RATIO);
   nPagesToWarmup = MIN(nPagesToWarmup, nTotalPages);
+
+  for (uint32_t i = 0; i < pFTLParam->pageCountToMaxPerf; i++) {
+    frontier.at(i) = &blocks.find(lastFreeBlock.at(i))->second;
+  }
+
+  // Fill blocks of stream 0 directly, in the same order as writeInternal.
+  // Warm-up never overwrites a page, so nothing is invalidated here.
+  for (lpn = 0; lpn < nPagesToWarmup; lpn++) {
+    uint32_t &index = lastFreeBlockIndex.at(0);
+    uint32_t blockIndex = lastFreeBlock.at(index);
+    uint32_t pageIndex = frontier.at(index)->getNextWritePageIndex(0);
+
+    if (pageIndex == pFTLParam->pagesInBlock) {
+      // writeInternal will trigger GC after this write, so let it handle
+      // remaining pages
+      if ((float)(freeBlocks.size() - 1) / pFTLParam->totalPhysicalBlocks <
+          threshold) {
+        break;
+      }
+
+      blockIndex = getLastFreeBlockAt(0, index);
+      frontier.at(index) = &blocks.find(blockIndex)->second;
+      pageIndex = 0;
+    }
+
+    frontier.at(index)->writePage(pageIndex, lpn, 0);
+    table.setMapping(lpn, blockIndex, pageIndex);
+
+    index++;
+
+    if (index == pFTLParam->pageCountToMaxPerf) {
+      index = 0;
+    }
+  }
+
   req.ioFlag.set();
 
-  for (req.lpn = 0; req.lpn < nPagesToWarmup; req.lpn++) {
+  for (req.lpn = lpn; req.lpn < nPagesToWarmup; req.lpn++) {
     tick = 0;
 
     writeInternal(req, tick, false);
   }
 
+  Logger::debugprint(
+      Logger::LOG_FTL_PAGE_MAPPING,
+      "INIT | Warm-up %" PRIu64 " pages (%" PRIu64 " by write path) | %.3f s",
+      nPagesToWarmup, nPagesToWarmup - lpn,
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - begin)
+          .count());
+
+  // Translation pages of warmed up LPNs are on flash
+  if (bDemandMapping) {
+    for (uint64_t tpn = 0; tpn * entriesInTranslationPage < nPagesToWarmup;
+         tpn++) {
+      tick = 0;
+
+      writeTranslationPage(tpn, tick, false);
+    }
+  }
+
+  // Fragment blocks as if the drive has been written for a long time
+  uint64_t nOverwrite =
+      nPagesToWarmup * conf.readFloat(FTL_PRECONDITION_OVERWRITE);
+
+  if (nOverwrite > 0) {
+    precondition(nPagesToWarmup, nOverwrite);
+    resetStats();
+  }
+
+  if (bExtentMapping) {
+    Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
+                       "INIT | Mapping table %" PRIu64 " extents, %" PRIu64
+                       " pages, %" PRIu64 " units | %" PRIu64 " / %" PRIu64
+                       " bytes",
+                       table.getExtentCount(), table.getPageEntryCount(),
+                       table.getUnitEntryCount(), table.getTableSize(),
+                       table.getDenseTableSize());
+  }
+
   return true;
 }
 
 void PageMapping::read(Request &req, uint64_t &tick) {
   uint64_t begin = tick;
+  bool duringGC = tick < gcBusyUntil;
+
+  doBackgroundFolding(tick);
+  doBackgroundGC(tick);
 
   readInternal(req, tick);
 
+  lastRequestFinishedAt = MAX(lastRequestFinishedAt, tick);
+
+  if (duringGC) {
+    stat.gcReadCount++;
+    stat.gcReadLatency += tick - begin;
+    stat.gcReadLatencyMax = MAX(stat.gcReadLatencyMax, tick - begin);
+  }
+
   Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
                      "READ  | LPN %" PRIu64 " | %" PRIu64 " - %" PRIu64
                      " (%" PRIu64 ")",
@@ -91,61 +322,108 @@ void PageMapping::read(Request &req, uint64_t &tick) {
 void PageMapping::write(Request &req, uint64_t &tick) {
   uint64_t begin = tick;
 
+  doBackgroundFolding(tick);
+  doBackgroundGC(tick);
+  doWearLeveling(tick);
+
   writeInternal(req, tick);
 
+  lastRequestFinishedAt = MAX(lastRequestFinishedAt, tick);
+
   Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
                      "WRITE | LPN %" PRIu64 " | %" PRIu64 " - %" PRIu64
                      " (%" PRIu64 ")",
                      req.lpn, begin, tick, tick - begin);
 }
 
+void PageMapping::read(std::vector<Request> &list, uint64_t &tick) {
+  uint64_t begin = tick;
+  bool duringGC = tick < gcBusyUntil;
+
+  doBackgroundFolding(tick);
+  doBackgroundGC(tick);
+
+  readInternal(list, tick);
+
+  lastRequestFinishedAt = MAX(lastRequestFinishedAt, tick);
+
+  if (duringGC) {
+    stat.gcReadCount += list.size();
+    stat.gcReadLatency += (tick - begin) * list.size();
+    stat.gcReadLatencyMax = MAX(stat.gcReadLatencyMax, tick - begin);
+  }
+
+  Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
+                     "READ  | %zu LPNs | %" PRIu64 " - %" PRIu64 " (%" PRIu64
+                     ")",
+                     list.size(), begin, tick, tick - begin);
+}
+
+void PageMapping::write(std::vector<Request> &list,
+                        std::vector<uint64_t> &finishedAt, uint64_t &tick) {
+  uint64_t begin = tick;
+
+  doBackgroundFolding(tick);
+  doBackgroundGC(tick);
+  doWearLeveling(tick);
+
+  writeInternal(list, finishedAt, tick);
+
+  lastRequestFinishedAt = MAX(lastRequestFinishedAt, tick);
+
+  Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
+                     "WRITE | %zu LPNs | %" PRIu64 " - %" PRIu64 " (%" PRIu64
+                     ")",
+                     list.size(), begin, tick, tick - begin);
+}
+
 void PageMapping::trim(Request &req, uint64_t &tick) {
   uint64_t begin = tick;
 
+  doBackgroundFolding(tick);
+  doBackgroundGC(tick);
+
   trimInternal(req, tick);
 
+  lastRequestFinishedAt = MAX(lastRequestFinishedAt, tick);
+
   Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
                      "TRIM  | LPN %" PRIu64 " | %" PRIu64 " - %" PRIu64
                      " (%" PRIu64 ")",
                      req.lpn, begin, tick, tick - begin);
 }
 
-void PageMapping::format(LPNRange &range, uint64_t &tick) {
-  PAL::Request req(pFTLParam->ioUnitInPage);
+void PageMapping::trim(LPNRange &range, uint64_t &tick) {
   std::vector<uint32_t> list;
+  uint64_t begin = tick;
 
-  req.ioFlag.set();
-
-  for (auto iter = table.begin(); iter != table.end();) {
-    if (iter->first >= range.slpn && iter->first < range.slpn + range.nlp) {
-      auto &mappingList = iter->second;
+  doBackgroundFolding(tick);
+  doBackgroundGC(tick);
 
-      // Do trim
-      for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
-        auto &mapping = mappingList.at(idx);
-        auto block = blocks.find(mapping.first);
+  trimRange(range, tick, list, true);
 
-        if (block == blocks.end()) {
-          Logger::panic("Block is not in use");
-        }
+  lastRequestFinishedAt = MAX(lastRequestFinishedAt, tick);
 
-        block->second.invalidate(mapping.second, idx);
+  Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
+                     "TRIM  | LPN %" PRIu64 " + %" PRIu64
+                     " | %u blocks | %" PRIu64 " - %" PRIu64 " (%" PRIu64 ")",
+                     range.slpn, range.nlp, list.size(), begin, tick,
+                     tick - begin);
+}
 
-        // Collect block indices
-        list.push_back(mapping.first);
-      }
+void PageMapping::format(LPNRange &range, uint64_t &tick) {
+  std::vector<uint32_t> list;
 
-      iter = table.erase(iter);
-    }
-    else {
-      iter++;
-    }
-  }
+  // Finish pending GC, so victims below are not reclaimed twice
+  doIncrementalGC(0, tick);
 
   // Get blocks to erase
-  std::sort(list.begin(), list.end());
-  auto last = std::unique(list.begin(), list.end());
-  list.erase(last, list.end());
+  trimRange(range, tick, list, false);
+
+  // SLC blocks are reclaimed by folding
+  list.erase(std::remove_if(list.begin(), list.end(),
+                            [this](uint32_t i) { return slcBlock.at(i); }),
+             list.end());
 
   // Do GC only in specified blocks
   doGarbageCollection(list, tick);
@@ -153,7 +431,7 @@ void PageMapping::format(LPNRange &range, uint64_t &tick) {
 
 Status *PageMapping::getStatus() {
   status.freePhysicalBlocks = freeBlocks.size();
-  status.mappedLogicalPages = table.size();
+  status.mappedLogicalPages = table.getMappedCount();
 
   return &status;
 }
@@ -162,11 +440,30 @@ float PageMapping::freeBlockRatio() {
   return (float)freeBlocks.size() / pFTLParam->totalPhysicalBlocks;
 }
 
+// Every stream may take one more block of the slot at any time, and copyback
+// needs one more to move pages of victim within its plane
+bool PageMapping::isStarving(uint32_t idx) {
+  static const bool useCopyback = conf.readBoolean(FTL_USE_COPYBACK);
+
+  return freeBlockSlots.at(idx).size() <
+         lastFreeBlockIndex.size() + (useCopyback ? 1 : 0);
+}
+
+bool PageMapping::hasStarvingSlot() {
+  for (uint32_t idx = 0; idx < pFTLParam->pageCountToMaxPerf; idx++) {
+    if (isStarving(idx)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 uint32_t PageMapping::convertBlockIdx(uint32_t blockIdx) {
   return blockIdx % pFTLParam->pageCountToMaxPerf;
 }
 
-uint32_t PageMapping::getFreeBlock(uint32_t idx) {
+uint32_t PageMapping::getFreeBlock(uint32_t idx, bool mostErased) {
   uint32_t blockIndex = 0;
 
   if (idx >= pFTLParam->pageCountToMaxPerf) {
@@ -174,36 +471,35 @@ uint32_t PageMapping::getFreeBlock(uint32_t idx) {
   }
 
   if (freeBlocks.size() > 0) {
-    uint32_t eraseCount = std::numeric_limits<uint32_t>::max();
-    auto found = freeBlocks.end();
-
-    // Found least erased block
-    for (auto iter = freeBlocks.begin(); iter != freeBlocks.end(); iter++) {
-      if (idx == convertBlockIdx(iter->first)) {
-        uint32_t current = iter->second.getEraseCount();
-
-        if (current < eraseCount) {
-          eraseCount = current;
-          blockIndex = iter->first;
-          found = iter;
-        }
-      }
-    }
+    auto &slot = freeBlockSlots.at(idx);
 
     // No free block found on specified index
-    if (found == freeBlocks.end()) {
+    if (slot.empty()) {
       Logger::panic("No free block at index %d found", idx);
     }
 
+    // Found least erased block, or most erased one for cold data
+    auto selected = mostErased ? std::prev(slot.end()) : slot.begin();
+
+    blockIndex = selected->second;
+
+    auto found = freeBlocks.find(blockIndex);
+
+    if (found == freeBlocks.end()) {
+      Logger::panic("Corrupted");
+    }
+
     // Insert found block to block list
     if (blocks.find(blockIndex) != blocks.end()) {
       Logger::panic("Corrupted");
     }
 
-    blocks.insert({blockIndex, found->second});
+    blocks.emplace(blockIndex, std::move(found->second));
+    victimIndex.at(0).insert(blockIndex);
 
     // Remove found block from free block list
     freeBlocks.erase(found);
+    slot.erase(selected);
   }
   else {
     Logger::panic("No free block left");
@@ -212,9 +508,111 @@ uint32_t PageMapping::getFreeBlock(uint32_t idx) {
   return blockIndex;
 }
 
-uint32_t PageMapping::getLastFreeBlock() {
-  auto freeBlock = blocks.find(lastFreeBlock.at(lastFreeBlockIndex));
-  uint32_t blockIndex = 0;
+uint32_t PageMapping::getLastFreeBlock(uint32_t stream, uint64_t tick) {
+  uint32_t &index = lastFreeBlockIndex.at(stream);
+
+  // Write to slot whose dies become idle first
+  // Scan from current index, so tie keeps static allocation order
+  if (bDynamicAllocation) {
+    uint64_t earliest = std::numeric_limits<uint64_t>::max();
+    uint32_t selected = index;
+
+    for (uint32_t i = 0; i < pFTLParam->pageCountToMaxPerf; i++) {
+      uint32_t slot = (index + i) % pFTLParam->pageCountToMaxPerf;
+
+      // Blocks in same slot share dies, so query slot-th block
+      uint64_t busyUntil = MAX(tick, pPAL->getBusyUntil(slot));
+
+      if (busyUntil < earliest) {
+        earliest = busyUntil;
+        selected = slot;
+      }
+    }
+
+    if (selected != index) {
+      stat.reorderedAllocations++;
+    }
+
+    index = selected;
+  }
+
+  // Skip slot whose block is full and has no free block to open
+  for (uint32_t i = 1; i < pFTLParam->pageCountToMaxPerf; i++) {
+    auto block = blocks.find(
+        lastFreeBlock.at(stream * pFTLParam->pageCountToMaxPerf + index));
+
+    if (freeBlockSlots.at(index).size() > 0 ||
+        block->second.getNextWritePageIndex() < pFTLParam->pagesInBlock) {
+      break;
+    }
+
+    index = (index + 1) % pFTLParam->pageCountToMaxPerf;
+  }
+
+  uint32_t blockIndex = getLastFreeBlockAt(stream, index);
+
+  // Update lastFreeBlockIndex
+  index++;
+
+  if (index == pFTLParam->pageCountToMaxPerf) {
+    index = 0;
+  }
+
+  return blockIndex;
+}
+
+uint32_t PageMapping::getWriteStream(uint64_t lpn) {
+  // Single stream, or host/GC separation only
+  if (streamCount <= 2) {
+    return streamCount - 1;
+  }
+
+  uint8_t &count = updateCount.at(lpn);
+
+  if (count < 0xFF) {
+    count++;
+  }
+
+  // Halve all counters after one full drive write, so old updates fade out
+  if (++updatesInEpoch == updateCount.size()) {
+    for (auto &iter : updateCount) {
+      iter >>= 1;
+    }
+
+    updatesInEpoch = 0;
+  }
+
+  // Hotness level is log2 of update count
+  uint32_t level = 0;
+
+  while ((count >> (level + 1)) > 0 && level < streamCount - 2) {
+    level++;
+  }
+
+  return level + 1;
+}
+
+void PageMapping::invalidatePage(
+    std::unordered_map<uint32_t, Block>::iterator block, uint32_t pageIndex,
+    uint32_t idx) {
+  uint32_t before = block->second.getDirtyPageCount();
+
+  block->second.invalidate(pageIndex, idx);
+
+  uint32_t after = block->second.getDirtyPageCount();
+
+  // Move block to new bucket (pending victims are not indexed)
+  if (before != after && victimIndex.at(before).erase(block->first) > 0) {
+    victimIndex.at(after).insert(block->first);
+  }
+}
+
+// Open block of stream in given slot, bypassing slot selection of
+// getLastFreeBlock
+uint32_t PageMapping::getLastFreeBlockAt(uint32_t stream, uint32_t idx) {
+  uint32_t &blockIndex =
+      lastFreeBlock.at(stream * pFTLParam->pageCountToMaxPerf + idx);
+  auto freeBlock = blocks.find(blockIndex);
 
   // Sanity check
   if (freeBlock == blocks.end()) {
@@ -223,18 +621,21 @@ uint32_t PageMapping::getLastFreeBlock() {
 
   // If current free block is full, get next block
   if (freeBlock->second.getNextWritePageIndex() == pFTLParam->pagesInBlock) {
-    lastFreeBlock.at(lastFreeBlockIndex) = getFreeBlock(lastFreeBlockIndex);
-
-    bReclaimMore = true;
-  }
+    openBlock.at(blockIndex) = false;
 
-  blockIndex = lastFreeBlock.at(lastFreeBlockIndex);
+    if (bWearLeveling && stream == wlStream) {
+      // Cold data is accounted to first stream
+      blockIndex = getFreeBlock(idx, true);
+      blockStream.at(blockIndex) = 0;
+    }
+    else {
+      blockIndex = getFreeBlock(idx);
+      blockStream.at(blockIndex) = stream;
+    }
 
-  // Update lastFreeBlockIndex
-  lastFreeBlockIndex++;
+    openBlock.at(blockIndex) = true;
 
-  if (lastFreeBlockIndex == pFTLParam->pageCountToMaxPerf) {
-    lastFreeBlockIndex = 0;
+    bReclaimMore = true;
   }
 
   return blockIndex;
@@ -243,16 +644,12 @@ uint32_t PageMapping::getLastFreeBlock() {
 void PageMapping::selectVictimBlock(std::vector<uint32_t> &list,
                                     uint64_t &tick) {
   static const GC_MODE mode = (GC_MODE)conf.readInt(FTL_GC_MODE);
-  static const EVICT_POLICY policy =
-      (EVICT_POLICY)conf.readInt(FTL_GC_EVICT_POLICY);
   uint64_t nBlocks = conf.readInt(FTL_GC_RECLAIM_BLOCK);
-  std::vector<std::pair<uint32_t, float>> weight;
-  uint64_t i = 0;
 
   list.clear();
 
   // Calculate number of blocks to reclaim
-  if (mode == GC_MODE_0) {
+  if (mode == GC_MODE_0 || mode == GC_MODE_2) {
     // DO NOTHING
   }
   else if (mode == GC_MODE_1) {
@@ -271,226 +668,1011 @@ void PageMapping::selectVictimBlock(std::vector<uint32_t> &list,
     bReclaimMore = false;
   }
 
-  // Calculate weights of all blocks
-  weight.resize(blocks.size());
+  getVictimBlocks(list, nBlocks, tick);
+
+  // Victims are selected regardless of slot, so one slot can run out of free
+  // blocks while others have plenty. Add most dirty block of such slot.
+  for (uint32_t idx = 0; idx < pFTLParam->pageCountToMaxPerf; idx++) {
+    bool found =
+        !isStarving(idx) ||
+        std::any_of(list.begin(), list.end(), [this, idx](uint32_t i) {
+          return convertBlockIdx(i) == idx;
+        });
+
+    for (uint32_t dirty = pFTLParam->pagesInBlock + 1; !found && dirty-- > 1;) {
+      for (auto &iter : victimIndex.at(dirty)) {
+        if (convertBlockIdx(iter) == idx && !openBlock.at(iter)) {
+          list.push_back(iter);
+          found = true;
+
+          break;
+        }
+      }
+    }
+  }
+}
+
+void PageMapping::getVictimBlocks(std::vector<uint32_t> &list,
+                                  uint64_t nBlocks, uint64_t &tick) {
+  static const EVICT_POLICY policy =
+      (EVICT_POLICY)conf.readInt(FTL_GC_EVICT_POLICY);
+
+  // Blocks still being written cannot be reclaimed. A full block is also
+  // kept until its stream takes next free block, as lastFreeBlock still
+  // points it.
+  auto isOpen = [this](uint32_t blockIndex) -> bool {
+    return openBlock.at(blockIndex);
+  };
+
+  list.clear();
+
+  nBlocks = MIN(nBlocks, blocks.size());
+
+  if (nBlocks == 0) {
+    return;
+  }
+
+  list.reserve(nBlocks);
 
   if (policy == POLICY_GREEDY) {
-    for (auto &iter : blocks) {
-      weight.at(i).first = iter.first;
-      weight.at(i).second =
-          pFTLParam->pagesInBlock - iter.second.getDirtyPageCount();
+    // Take blocks from the most dirty bucket
+    for (uint32_t dirty = pFTLParam->pagesInBlock + 1; dirty-- > 0;) {
+      for (auto &iter : victimIndex.at(dirty)) {
+        if (isOpen(iter)) {
+          continue;
+        }
+
+        list.push_back(iter);
 
-      i++;
+        if (list.size() == nBlocks) {
+          return;
+        }
+      }
     }
   }
   else if (policy == POLICY_COST_BENEFIT) {
+    std::vector<std::pair<uint32_t, float>> weight;
     float temp;
 
-    for (auto &iter : blocks) {
-      temp =
-          (float)(pFTLParam->pagesInBlock - iter.second.getDirtyPageCount()) /
-          pFTLParam->pagesInBlock;
+    // Blocks without dirty page have infinite weight, so they are considered
+    // only when dirty blocks are not enough
+    uint32_t minDirty = 1;
+
+    if (blocks.size() - victimIndex.at(0).size() < nBlocks) {
+      minDirty = 0;
+    }
+
+    weight.reserve(blocks.size());
+
+    for (uint32_t dirty = minDirty; dirty <= pFTLParam->pagesInBlock;
+         dirty++) {
+      temp = (float)(pFTLParam->pagesInBlock - dirty) / pFTLParam->pagesInBlock;
+
+      for (auto &iter : victimIndex.at(dirty)) {
+        if (isOpen(iter)) {
+          continue;
+        }
+
+        uint64_t age = tick - blocks.find(iter)->second.getLastAccessedTime();
+
+        weight.push_back(std::make_pair(iter, temp / ((1 - temp) * age)));
+      }
+    }
+
+    auto compare = [](std::pair<uint32_t, float> a,
+                      std::pair<uint32_t, float> b) -> bool {
+      return a.second < b.second;
+    };
+
+    nBlocks = MIN(nBlocks, weight.size());
 
-      weight.at(i).first = iter.first;
-      weight.at(i).second =
-          temp / ((1 - temp) * (tick - iter.second.getLastAccessedTime()));
+    // Select nBlocks smallest weights
+    if (nBlocks < weight.size()) {
+      std::nth_element(weight.begin(), weight.begin() + nBlocks, weight.end(),
+                       compare);
+    }
+
+    std::sort(weight.begin(), weight.begin() + nBlocks, compare);
 
-      i++;
+    for (uint64_t i = 0; i < nBlocks; i++) {
+      list.push_back(weight.at(i).first);
     }
   }
   else {
     Logger::panic("Invalid evict policy");
   }
+}
 
-  // Sort weights
-  std::sort(
-      weight.begin(), weight.end(),
-      [](std::pair<uint32_t, float> a, std::pair<uint32_t, float> b) -> bool {
-        return a.second < b.second;
-      });
+// Pages moved out of GC victim. Translation blocks are not in any stream.
+void PageMapping::countGCPages(uint32_t blockIndex, uint64_t pages) {
+  uint32_t stream = blockStream.at(blockIndex);
 
-  // Select victims
-  i = 0;
-  list.resize(nBlocks);
+  stat.gcPages += pages;
 
-  for (auto &iter : list) {
-    iter = weight.at(i++).first;
+  if (stream < streamCount) {
+    streamStat.at(stream).gcPages += pages;
   }
 }
 
-void PageMapping::doGarbageCollection(std::vector<uint32_t> &blocksToReclaim,
-                                      uint64_t &tick) {
+bool PageMapping::migratePage(
+    std::unordered_map<uint32_t, Block>::iterator block, uint32_t pageIndex,
+    uint64_t tick, uint64_t &finishedAt, bool sendToPAL, uint32_t stream) {
+  static const bool useCopyback = conf.readBoolean(FTL_USE_COPYBACK);
   PAL::Request req(pFTLParam->ioUnitInPage);
   std::vector<uint64_t> lpns;
   DynamicBitset bit(pFTLParam->ioUnitInPage);
   uint64_t beginAt;
   uint64_t beginAt2;
-  uint64_t finishedAt = tick;
-  uint64_t finishedAt2 = tick;
 
-  if (blocksToReclaim.size() == 0) {
-    return;
+  if (bDemandMapping && blockStream.at(block->first) == streamCount) {
+    return migrateTranslationPage(block, pageIndex, tick, finishedAt,
+                                  sendToPAL);
   }
 
-  // For all blocks to reclaim
-  for (auto &iter : blocksToReclaim) {
-    auto block = blocks.find(iter);
-
-    if (block == blocks.end()) {
-      Logger::panic("Invalid block");
-    }
-
-    // Copy valid pages to free block
-    for (uint32_t pageIndex = 0; pageIndex < pFTLParam->pagesInBlock;
-         pageIndex++) {
-      // Valid?
-      if (block->second.getPageInfo(pageIndex, lpns, bit)) {
-        // Retrive free block
-        auto freeBlock = blocks.find(getLastFreeBlock());
+  // Valid?
+  if (!block->second.getPageInfo(pageIndex, lpns, bit)) {
+    return false;
+  }
 
-        // Issue Read
-        req.blockIndex = block->first;
-        req.pageIndex = pageIndex;
-        req.ioFlag = bit;
+  if (sendToPAL) {
+    pFirmware->execute(FIRMWARE_GC, bit.count(), tick);
+  }
 
-        beginAt = tick;
+  // Blocks in same slot are on same plane. Use read and write instead when
+  // the slot has no page left to program.
+  uint32_t slot = convertBlockIdx(block->first);
+  bool copyback = false;
 
-        pPAL->read(req, beginAt);
+  if (useCopyback) {
+    auto lastBlock = blocks.find(
+        lastFreeBlock.at(stream * pFTLParam->pageCountToMaxPerf + slot));
 
-        // Update mapping table
-        uint32_t newBlockIdx = freeBlock->first;
+    copyback =
+        freeBlockSlots.at(slot).size() > 0 ||
+        lastBlock->second.getNextWritePageIndex() < pFTLParam->pagesInBlock;
+  }
 
-        for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
-          if (bit.test(idx)) {
-            // Invalidate
-            block->second.invalidate(pageIndex, idx);
+  if (copyback) {
+    auto freeBlock = blocks.find(getLastFreeBlockAt(stream, slot));
+    uint32_t newBlockIdx = freeBlock->first;
 
-            auto mappingList = table.find(lpns.at(idx));
+    for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
+      if (bit.test(idx)) {
+        // Invalidate
+        invalidatePage(block, pageIndex, idx);
 
-            if (mappingList == table.end()) {
-              Logger::panic("Invalid mapping table entry");
-            }
+        if (!table.isMapped(lpns.at(idx))) {
+          Logger::panic("Invalid mapping table entry");
+        }
 
-            auto &mapping = mappingList->second.at(idx);
+        uint32_t newPageIdx = freeBlock->second.getNextWritePageIndex(idx);
 
-            uint32_t newPageIdx = freeBlock->second.getNextWritePageIndex(idx);
+        table.setMapping(lpns.at(idx), idx, newBlockIdx, newPageIdx);
+        markTranslationDirty(lpns.at(idx));
 
-            mapping.first = newBlockIdx;
-            mapping.second = newPageIdx;
+        freeBlock->second.write(newPageIdx, lpns.at(idx), idx, tick);
 
-            freeBlock->second.write(newPageIdx, lpns.at(idx), idx, beginAt);
+        if (sendToPAL) {
+          // Issue Copyback
+          req.blockIndex = block->first;
+          req.pageIndex = pageIndex;
+          req.ioFlag.reset();
+          req.ioFlag.set(idx);
 
-            // Issue Write
-            req.blockIndex = newBlockIdx;
-            req.pageIndex = newPageIdx;
-            req.ioFlag.reset();
-            req.ioFlag.set(idx);
+          beginAt = tick;
 
-            beginAt2 = beginAt;
+          pPAL->copyback(req, newBlockIdx, newPageIdx, beginAt);
 
-            pPAL->write(req, beginAt2);
+          finishedAt = MAX(finishedAt, beginAt);
 
-            finishedAt2 = MAX(finishedAt2, beginAt2);
-          }
+          stat.copybackPages++;
+          stat.programmedPages++;
         }
       }
     }
 
-    // Erase block
-    req.blockIndex = block->first;
-    req.pageIndex = 0;
-    req.ioFlag.set();
-
-    eraseInternal(req, finishedAt2);
-
-    // Merge timing
-    finishedAt = MAX(finishedAt, finishedAt2);
+    return true;
   }
 
-  tick = finishedAt;
-}
+  // Retrive free block
+  auto freeBlock = blocks.find(getLastFreeBlock(stream, tick));
 
-void PageMapping::readInternal(Request &req, uint64_t &tick) {
-  PAL::Request palRequest(req);
-  uint64_t beginAt;
-  uint64_t finishedAt = tick;
+  // Issue Read
+  req.blockIndex = block->first;
+  req.pageIndex = pageIndex;
+  req.ioFlag = bit;
 
-  auto mappingList = table.find(req.lpn);
+  beginAt = tick;
 
-  if (mappingList != table.end()) {
-    latency.access(req.ioFlag.count(), tick);
+  if (sendToPAL) {
+    pPAL->read(req, beginAt);
+  }
 
-    for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
-      if (req.ioFlag.test(idx)) {
-        auto &mapping = mappingList->second.at(idx);
+  // Update mapping table
+  uint32_t newBlockIdx = freeBlock->first;
 
-        if (mapping.first < pFTLParam->totalPhysicalBlocks &&
-            mapping.second < pFTLParam->pagesInBlock) {
-          palRequest.blockIndex = mapping.first;
-          palRequest.pageIndex = mapping.second;
-          palRequest.ioFlag.reset();
-          palRequest.ioFlag.set(idx);
+  for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
+    if (bit.test(idx)) {
+      // Invalidate
+      invalidatePage(block, pageIndex, idx);
 
-          auto block = blocks.find(palRequest.blockIndex);
+      if (!table.isMapped(lpns.at(idx))) {
+        Logger::panic("Invalid mapping table entry");
+      }
 
-          if (block == blocks.end()) {
-            Logger::panic("Block is not in use");
-          }
+      uint32_t newPageIdx = freeBlock->second.getNextWritePageIndex(idx);
 
-          beginAt = tick;
+      table.setMapping(lpns.at(idx), idx, newBlockIdx, newPageIdx);
+      markTranslationDirty(lpns.at(idx));
 
-          block->second.read(palRequest.pageIndex, idx, beginAt);
-          pPAL->read(palRequest, beginAt);
+      freeBlock->second.write(newPageIdx, lpns.at(idx), idx, beginAt);
 
-          finishedAt = MAX(finishedAt, beginAt);
-        }
+      if (sendToPAL) {
+        // Issue Write
+        req.blockIndex = newBlockIdx;
+        req.pageIndex = newPageIdx;
+        req.ioFlag.reset();
+        req.ioFlag.set(idx);
+
+        beginAt2 = beginAt;
+
+        pPAL->write(req, beginAt2);
+
+        finishedAt = MAX(finishedAt, beginAt2);
+
+        stat.programmedPages++;
+      }
+    }
+  }
+
+  return true;
+}
+
+void PageMapping::countVictim(Block &block) {
+  uint32_t bucket = block.getValidPageCount() * 10 / pFTLParam->pagesInBlock;
+
+  stat.victimValid[MIN(bucket, 9)]++;
+}
+
+void PageMapping::doGarbageCollection(std::vector<uint32_t> &blocksToReclaim,
+                                      uint64_t &tick, bool sendToPAL) {
+  PAL::Request req(pFTLParam->ioUnitInPage);
+  uint64_t finishedAt = tick;
+  uint64_t finishedAt2 = tick;
+
+  if (blocksToReclaim.size() == 0) {
+    return;
+  }
+
+  // For all blocks to reclaim
+  for (auto &iter : blocksToReclaim) {
+    auto block = blocks.find(iter);
+
+    if (block == blocks.end()) {
+      Logger::panic("Invalid block");
+    }
+
+    // Copy valid pages to free block
+    uint64_t programmed = stat.programmedPages;
+
+    for (uint32_t pageIndex = 0; pageIndex < pFTLParam->pagesInBlock;
+         pageIndex++) {
+      migratePage(block, pageIndex, tick, finishedAt2, sendToPAL);
+    }
+
+    countGCPages(block->first, stat.programmedPages - programmed);
+
+    flushTranslationUpdates(finishedAt2, sendToPAL);
+
+    // Erase block
+    req.blockIndex = block->first;
+    req.pageIndex = 0;
+    req.ioFlag.set();
+
+    eraseInternal(req, finishedAt2, sendToPAL);
+
+    // Merge timing
+    finishedAt = MAX(finishedAt, finishedAt2);
+  }
+
+  tick = finishedAt;
+  gcBusyUntil = MAX(gcBusyUntil, finishedAt);
+}
+
+void PageMapping::doIncrementalGC(uint64_t limit, uint64_t &tick) {
+  PAL::Request req(pFTLParam->ioUnitInPage);
+  uint64_t copied = 0;
+  uint64_t finishedAt = tick;
+
+  // Continue pending victims, copying at most limit valid pages
+  while (pendingVictims.size() > 0 && (limit == 0 || copied < limit)) {
+    auto block = blocks.find(pendingVictims.front());
+
+    if (block == blocks.end()) {
+      Logger::panic("Invalid block");
+    }
+
+    uint64_t programmed = stat.programmedPages;
+
+    for (; gcPageIndex < pFTLParam->pagesInBlock; gcPageIndex++) {
+      if (limit > 0 && copied == limit) {
+        break;
+      }
+
+      if (migratePage(block, gcPageIndex, tick, finishedAt)) {
+        copied++;
       }
     }
 
-    tick = finishedAt;
+    countGCPages(block->first, stat.programmedPages - programmed);
+
+    // Erase must wait for copies issued in previous steps
+    gcFinishedAt = MAX(gcFinishedAt, finishedAt);
+
+    if (gcPageIndex < pFTLParam->pagesInBlock) {
+      break;
+    }
+
+    flushTranslationUpdates(gcFinishedAt, true);
+
+    // Erase block
+    req.blockIndex = block->first;
+    req.pageIndex = 0;
+    req.ioFlag.set();
+
+    eraseInternal(req, gcFinishedAt);
+
+    finishedAt = MAX(finishedAt, gcFinishedAt);
+
+    pendingVictims.pop_front();
+    gcPageIndex = 0;
+  }
+
+  tick = finishedAt;
+  gcBusyUntil = MAX(gcBusyUntil, finishedAt);
+}
+
+void PageMapping::doBackgroundGC(uint64_t tick) {
+  static const GC_MODE mode = (GC_MODE)conf.readInt(FTL_GC_MODE);
+  static const float low = conf.readFloat(FTL_GC_BG_LOW_WATERMARK);
+  static const float high = conf.readFloat(FTL_GC_BG_HIGH_WATERMARK);
+  std::vector<uint32_t> list;
+  uint64_t beginAt = MAX(lastRequestFinishedAt, lastGCFinishedAt);
+  uint64_t reclaimed = 0;
+
+  if (mode != GC_MODE_2) {
+    return;
+  }
+
+  if (!bBackgroundGC && freeBlockRatio() < low) {
+    bBackgroundGC = true;
+  }
+
+  // Reclaim one block at a time while it fits in idle time
+  while (bBackgroundGC && beginAt + bgReclaimLatency < tick) {
+    uint64_t finishedAt = beginAt;
+
+    getVictimBlocks(list, 1, finishedAt);
+
+    // Stop if nothing can be gained
+    if (list.size() == 0 ||
+        blocks.find(list.front())->second.getDirtyPageCount() == 0) {
+      bBackgroundGC = false;
+
+      break;
+    }
+
+    countVictim(blocks.find(list.front())->second);
+    doGarbageCollection(list, finishedAt);
+
+    bgReclaimLatency = finishedAt - beginAt;
+    stat.bgGCTime += bgReclaimLatency;
+    bgGCLatency.add(bgReclaimLatency);
+    beginAt = finishedAt;
+    reclaimed++;
+
+    if (freeBlockRatio() >= high) {
+      bBackgroundGC = false;
+    }
+  }
+
+  if (reclaimed > 0) {
+    Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
+                       "GC   | Background | %" PRIu64
+                       " blocks reclaimed | %" PRIu64 " - %" PRIu64,
+                       reclaimed, MAX(lastRequestFinishedAt, lastGCFinishedAt),
+                       beginAt);
+
+    lastGCFinishedAt = beginAt;
+
+    stat.gcCount++;
+    stat.bgGCCount++;
+    stat.reclaimedBlocks += reclaimed;
+    stat.bgReclaimedBlocks += reclaimed;
+  }
+}
+
+void PageMapping::doWearLeveling(uint64_t tick) {
+  PAL::Request req(pFTLParam->ioUnitInPage);
+  uint32_t blockIndex = 0;
+  uint32_t eraseCount = std::numeric_limits<uint32_t>::max();
+  uint64_t copied = 0;
+  uint64_t finishedAt = tick;
+
+  if (!bWearLeveling || !wearLeveling.isTriggered()) {
+    return;
+  }
+
+  // Find least erased block holding data. Open blocks, SLC blocks and
+  // pending GC victims (not in victim index) are skipped.
+  for (auto &iter : blocks) {
+    if (iter.second.getEraseCount() >= eraseCount ||
+        iter.second.getValidPageCount() == 0 || openBlock.at(iter.first) ||
+        slcBlock.at(iter.first) ||
+        victimIndex.at(iter.second.getDirtyPageCount()).count(iter.first) ==
+            0) {
+      continue;
+    }
+
+    blockIndex = iter.first;
+    eraseCount = iter.second.getEraseCount();
+  }
+
+  if (eraseCount == std::numeric_limits<uint32_t>::max() ||
+      !wearLeveling.isCold(eraseCount)) {
+    return;
+  }
+
+  auto block = blocks.find(blockIndex);
+  uint64_t programmed = stat.programmedPages;
+
+  // Issued at arrival of this request, so it competes for dies with host I/O
+  for (uint32_t pageIndex = 0; pageIndex < pFTLParam->pagesInBlock;
+       pageIndex++) {
+    if (migratePage(block, pageIndex, tick, finishedAt, true, wlStream)) {
+      copied++;
+    }
+  }
+
+  if (blockStream.at(blockIndex) < streamCount) {
+    streamStat.at(blockStream.at(blockIndex)).wlPages +=
+        stat.programmedPages - programmed;
+  }
+
+  flushTranslationUpdates(finishedAt, true);
+
+  req.blockIndex = blockIndex;
+  req.pageIndex = 0;
+  req.ioFlag.set();
+
+  eraseInternal(req, finishedAt);
+
+  Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
+                     "WL   | Block %u (erased %u, max %u) | %" PRIu64
+                     " pages | %" PRIu64 " - %" PRIu64,
+                     blockIndex, eraseCount, wearLeveling.getMaxEraseCount(),
+                     copied, tick, finishedAt);
+
+  stat.wlCount++;
+  stat.wlPages += copied;
+  stat.wlTime += finishedAt - tick;
+}
+
+void PageMapping::precondition(uint64_t nPages, uint64_t nOverwrite) {
+  static const float threshold = conf.readFloat(FTL_GC_THRESHOLD_RATIO);
+  std::mt19937_64 gen(0);
+  std::uniform_int_distribution<uint64_t> dist(0, nPages - 1);
+  std::vector<uint32_t> list;
+  uint32_t blockIndex;
+  uint32_t pageIndex;
+  uint64_t tick = 0;
+  uint64_t gcCount = 0;
+  uint64_t dirtyPages = 0;
+  auto begin = std::chrono::steady_clock::now();
+
+  // Uniform overwrites have no hot data, so use first host stream
+  uint32_t stream = streamCount > 1 ? 1 : 0;
+
+  for (uint64_t i = 0; i < nOverwrite; i++) {
+    uint64_t lpn = dist(gen);
+
+    for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
+      if (table.getMapping(lpn, idx, blockIndex, pageIndex)) {
+        invalidatePage(blocks.find(blockIndex), pageIndex, idx);
+      }
+    }
+
+    auto block = blocks.find(getLastFreeBlock(stream, tick));
+
+    for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
+      pageIndex = block->second.getNextWritePageIndex(idx);
+
+      block->second.write(pageIndex, lpn, idx, tick);
+      table.setMapping(lpn, idx, block->first, pageIndex);
+    }
+
+    // Reclaim without sending anything to PAL
+    if (freeBlockRatio() < threshold || hasStarvingSlot()) {
+      selectVictimBlock(list, tick);
+      doGarbageCollection(list, tick, false);
+
+      gcCount++;
+    }
+  }
+
+  for (uint32_t dirty = 1; dirty <= pFTLParam->pagesInBlock; dirty++) {
+    dirtyPages += dirty * victimIndex.at(dirty).size();
+  }
+
+  Logger::debugprint(
+      Logger::LOG_FTL_PAGE_MAPPING,
+      "INIT | Precondition %" PRIu64 " overwrites, %" PRIu64
+      " GC | Dirty pages %.2f%% | %.3f s",
+      nOverwrite, gcCount,
+      dirtyPages * 100. / (blocks.size() * pFTLParam->pagesInBlock),
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - begin)
+          .count());
+}
+
+uint32_t PageMapping::getSLCBlock(uint64_t &tick) {
+  uint32_t slot = slcFrontierIndex;
+  uint32_t &blockIndex = slcFrontier.at(slot);
+  auto block = blocks.find(blockIndex);
+
+  if (block == blocks.end()) {
+    Logger::panic("Corrupted");
+  }
+
+  // If current SLC block is full, get next block
+  if (slcNextPage.at(block->second.getNextWritePageIndex()) ==
+      pFTLParam->pagesInBlock) {
+    slcFullBlocks.at(slot).push_back(blockIndex);
+
+    // Region is full, so this write waits for folding
+    if (slcFreeBlocks.at(slot).empty()) {
+      uint64_t beginAt = tick;
+
+      foldSLCBlock(slot, tick);
+
+      stat.slcFullCount++;
+      stat.slcFgFoldTime += tick - beginAt;
+    }
+
+    blockIndex = slcFreeBlocks.at(slot).front();
+    slcFreeBlocks.at(slot).pop_front();
+  }
+
+  slcFrontierIndex++;
+
+  if (slcFrontierIndex == pFTLParam->pageCountToMaxPerf) {
+    slcFrontierIndex = 0;
+  }
+
+  return blockIndex;
+}
+
+void PageMapping::foldSLCBlock(uint32_t slot, uint64_t &tick) {
+  PAL::Request req(pFTLParam->ioUnitInPage);
+  uint32_t blockIndex = slcFullBlocks.at(slot).front();
+  auto block = blocks.find(blockIndex);
+  uint64_t finishedAt = tick;
+  uint64_t programmed = stat.programmedPages;
+
+  slcFullBlocks.at(slot).pop_front();
+
+  // Data survived in SLC region is cold, so write it to normal blocks of
+  // first stream
+  for (uint32_t pageIndex = slcNextPage.at(0);
+       pageIndex < pFTLParam->pagesInBlock;
+       pageIndex = slcNextPage.at(pageIndex + 1)) {
+    migratePage(block, pageIndex, tick, finishedAt);
+  }
+
+  stat.slcFoldedPages += stat.programmedPages - programmed;
+
+  flushTranslationUpdates(finishedAt, true);
+
+  if (block->second.getValidPageCount() != 0) {
+    Logger::panic("There are valid pages in folded block");
+  }
+
+  // Erase block, and put it back to SLC region
+  req.blockIndex = blockIndex;
+  req.pageIndex = 0;
+  req.ioFlag.set();
+
+  eraseInternal(req, finishedAt);
+
+  stat.slcFoldedBlocks++;
+
+  tick = finishedAt;
+}
+
+void PageMapping::doBackgroundFolding(uint64_t tick) {
+  uint64_t beginAt = MAX(lastRequestFinishedAt, lastFoldFinishedAt);
+  uint64_t folded = 0;
+
+  if (slcBlocksPerSlot == 0) {
+    return;
+  }
+
+  // Fold one block at a time while it fits in idle time
+  while (beginAt + foldLatency < tick) {
+    uint32_t slot = 0;
+
+    // Fold slot with most full blocks first
+    for (uint32_t i = 1; i < slcFullBlocks.size(); i++) {
+      if (slcFullBlocks.at(i).size() > slcFullBlocks.at(slot).size()) {
+        slot = i;
+      }
+    }
+
+    if (slcFullBlocks.at(slot).empty()) {
+      break;
+    }
+
+    uint64_t finishedAt = beginAt;
+
+    foldSLCBlock(slot, finishedAt);
+
+    foldLatency = finishedAt - beginAt;
+    stat.slcBgFoldTime += foldLatency;
+    beginAt = finishedAt;
+    folded++;
+  }
+
+  if (folded > 0) {
+    Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
+                       "SLC  | Background | %" PRIu64
+                       " blocks folded | %" PRIu64 " - %" PRIu64,
+                       folded, MAX(lastRequestFinishedAt, lastFoldFinishedAt),
+                       beginAt);
+
+    lastFoldFinishedAt = beginAt;
+  }
+}
+
+void PageMapping::translate(uint64_t lpn, bool update, uint64_t &tick) {
+  uint64_t tpn = lpn / entriesInTranslationPage;
+  uint64_t entrySize = pFTLParam->ioUnitInPage * sizeof(uint32_t);
+
+  if (!bDemandMapping) {
+    return;
+  }
+
+  if (cmt.access(tpn)) {
+    stat.cmtHit++;
+  }
+  else {
+    stat.cmtMiss++;
+
+    // Make room for missed translation page
+    if (cmt.isFull()) {
+      bool dirty;
+      uint64_t victim = cmt.evict(dirty);
+
+      if (dirty) {
+        writeTranslationPage(victim, tick);
+
+        stat.cmtWriteback++;
+      }
+    }
+
+    readTranslationPage(tpn, tick);
+    cmt.insert(tpn);
+
+    pDRAM->write(nullptr, pFTLParam->pageSize, tick);
+  }
+
+  if (update) {
+    cmt.setDirty(tpn);
+
+    pDRAM->write(nullptr, entrySize, tick);
+  }
+  else {
+    pDRAM->read(nullptr, entrySize, tick);
+  }
+}
+
+void PageMapping::markTranslationDirty(uint64_t lpn) {
+  uint64_t tpn = lpn / entriesInTranslationPage;
+
+  if (!bDemandMapping) {
+    return;
+  }
+
+  // Uncached translation pages are updated on flash after GC
+  if (!cmt.setDirty(tpn)) {
+    gcTranslationUpdates.insert(tpn);
+  }
+}
+
+void PageMapping::readTranslationPage(uint64_t tpn, uint64_t &tick) {
+  PAL::Request req(pFTLParam->ioUnitInPage);
+  uint32_t blockIndex;
+  uint32_t pageIndex;
+
+  // Translation page never written holds no mapping
+  if (gtd.getMapping(tpn, 0, blockIndex, pageIndex)) {
+    req.blockIndex = blockIndex;
+    req.pageIndex = pageIndex;
+    req.ioFlag.set();
+
+    pPAL->read(req, tick);
+  }
+}
+
+void PageMapping::writeTranslationPage(uint64_t tpn, uint64_t &tick,
+                                       bool sendToPAL) {
+  PAL::Request req(pFTLParam->ioUnitInPage);
+  uint32_t blockIndex;
+  uint32_t pageIndex;
+
+  // Invalidate previous copy
+  if (gtd.getMapping(tpn, 0, blockIndex, pageIndex)) {
+    auto block = blocks.find(blockIndex);
+
+    if (block == blocks.end()) {
+      Logger::panic("Block is not in use");
+    }
+
+    for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
+      invalidatePage(block, pageIndex, idx);
+    }
+  }
+
+  auto block = blocks.find(getLastFreeBlock(streamCount, tick));
+
+  pageIndex = block->second.getNextWritePageIndex();
+
+  block->second.writePage(pageIndex, tpn, tick);
+  gtd.setMapping(tpn, block->first, pageIndex);
+
+  if (sendToPAL) {
+    req.blockIndex = block->first;
+    req.pageIndex = pageIndex;
+    req.ioFlag.set();
+
+    pPAL->write(req, tick);
+
+    stat.programmedPages += pFTLParam->ioUnitInPage;
+  }
+}
+
+bool PageMapping::migrateTranslationPage(
+    std::unordered_map<uint32_t, Block>::iterator block, uint32_t pageIndex,
+    uint64_t tick, uint64_t &finishedAt, bool sendToPAL) {
+  std::vector<uint64_t> tpns;
+  DynamicBitset bit(pFTLParam->ioUnitInPage);
+
+  // Valid?
+  if (!block->second.getPageInfo(pageIndex, tpns, bit)) {
+    return false;
+  }
+
+  if (sendToPAL) {
+    readTranslationPage(tpns.front(), tick);
+  }
+
+  writeTranslationPage(tpns.front(), tick, sendToPAL);
+
+  finishedAt = MAX(finishedAt, tick);
+
+  stat.gcTranslationPages++;
+
+  return true;
+}
+
+void PageMapping::flushTranslationUpdates(uint64_t &tick, bool sendToPAL) {
+  uint64_t finishedAt = tick;
+
+  // Read-modify-write each translation page once
+  for (auto &tpn : gcTranslationUpdates) {
+    uint64_t beginAt = tick;
+
+    if (sendToPAL) {
+      readTranslationPage(tpn, beginAt);
+    }
+
+    writeTranslationPage(tpn, beginAt, sendToPAL);
+
+    finishedAt = MAX(finishedAt, beginAt);
+
+    stat.gcTranslationUpdates++;
+  }
+
+  gcTranslationUpdates.clear();
+
+  tick = finishedAt;
+}
+
+void PageMapping::readInternal(Request &req, uint64_t &tick) {
+  std::map<uint64_t, PAL::Request> pages;
+
+  translate(req.lpn, false, tick);
+
+  if (table.isMapped(req.lpn)) {
+    pFirmware->execute(FIRMWARE_MAP_LOOKUP, req.ioFlag.count(), tick);
+
+    readUnits(req, pages, tick);
+    submitPages(pages, false, tick);
+  }
+}
+
+void PageMapping::readInternal(std::vector<Request> &list, uint64_t &tick) {
+  std::map<uint64_t, PAL::Request> pages;
+  uint32_t units = 0;
+
+  for (auto &req : list) {
+    translate(req.lpn, false, tick);
+
+    if (table.isMapped(req.lpn)) {
+      units += req.ioFlag.count();
+    }
+  }
+
+  if (units > 0) {
+    // Firmware handles the whole batch as one request
+    pFirmware->execute(FIRMWARE_MAP_LOOKUP, units, tick);
+
+    for (auto &req : list) {
+      readUnits(req, pages, tick);
+    }
+
+    submitPages(pages, false, tick);
   }
 }
 
 void PageMapping::writeInternal(Request &req, uint64_t &tick, bool sendToPAL) {
-  PAL::Request palRequest(req);
-  std::unordered_map<uint32_t, Block>::iterator block;
-  auto mappingList = table.find(req.lpn);
-  uint64_t beginAt;
-  uint64_t finishedAt = tick;
+  std::map<uint64_t, PAL::Request> pages;
+  uint64_t begin = tick;
+
+  pFirmware->execute(FIRMWARE_MAP_UPDATE, req.ioFlag.count(), tick);
+
+  if (sendToPAL) {
+    translate(req.lpn, true, tick);
+  }
+
+  invalidateUnits(req);
+
+  // Write data to free block
+  // Data written at warm-up is treated as cold
+  uint32_t stream = sendToPAL ? getWriteStream(req.lpn) : 0;
+  bool toSLC = sendToPAL && slcBlocksPerSlot > 0;
+  uint32_t blockIndex =
+      toSLC ? getSLCBlock(tick) : getLastFreeBlock(stream, tick);
+
+  writeUnits(req, blockIndex, stream, toSLC, pages, tick, sendToPAL);
+
+  if (sendToPAL) {
+    submitPages(pages, true, tick);
+  }
+
+  if (toSLC) {
+    countSLCHostPages(req.ioFlag.count(), begin, tick);
+  }
+
+  doOnDemandGC(tick);
+}
+
+void PageMapping::writeInternal(std::vector<Request> &list,
+                                std::vector<uint64_t> &finishedAt,
+                                uint64_t &tick) {
+  std::map<uint64_t, PAL::Request> pages;
+  std::unordered_map<uint64_t, uint64_t> pageFinishedAt;
+  std::vector<uint32_t> packedBlock(lastFreeBlockIndex.size(),
+                                    pFTLParam->totalPhysicalBlocks);
+  std::vector<DynamicBitset> packedUnits(
+      lastFreeBlockIndex.size(), DynamicBitset(pFTLParam->ioUnitInPage));
+  uint64_t begin = tick;
+  uint32_t units = 0;
+  bool toSLC = slcBlocksPerSlot > 0;
 
-  latency.access(req.ioFlag.count(), tick);
+  for (auto &req : list) {
+    units += req.ioFlag.count();
+  }
+
+  // Firmware handles the whole batch as one request
+  pFirmware->execute(FIRMWARE_MAP_UPDATE, units, tick);
+
+  for (auto &req : list) {
+    uint32_t stream;
+    uint32_t blockIndex;
+
+    translate(req.lpn, true, tick);
+    invalidateUnits(req);
+
+    stream = getWriteStream(req.lpn);
+
+    if (toSLC) {
+      blockIndex = getSLCBlock(tick);
+    }
+    else {
+      // Requests of one stream share a super page while their I/O units do
+      // not overlap, so PAL programs them with one multi-plane operation
+      uint32_t &packed = packedBlock.at(stream);
+      DynamicBitset &used = packedUnits.at(stream);
+
+      if (packed == pFTLParam->totalPhysicalBlocks ||
+          (used & req.ioFlag).any()) {
+        packed = getLastFreeBlock(stream, tick);
+        used.reset();
+      }
+
+      used |= req.ioFlag;
+      blockIndex = packed;
+    }
+
+    writeUnits(req, blockIndex, stream, toSLC, pages, tick, true);
+  }
+
+  submitPages(pages, true, tick, &pageFinishedAt);
+
+  // Request finishes when the last of its pages is programmed
+  finishedAt.assign(list.size(), 0);
+
+  for (uint64_t i = 0; i < list.size(); i++) {
+    uint32_t blockIndex;
+    uint32_t pageIndex;
 
-  if (mappingList != table.end()) {
     for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
-      if (req.ioFlag.test(idx)) {
-        auto &mapping = mappingList->second.at(idx);
+      if (list.at(i).ioFlag.test(idx) &&
+          table.getMapping(list.at(i).lpn, idx, blockIndex, pageIndex)) {
+        finishedAt.at(i) =
+            MAX(finishedAt.at(i),
+                pageFinishedAt[((uint64_t)blockIndex << 32) | pageIndex]);
+      }
+    }
+  }
+
+  if (toSLC) {
+    countSLCHostPages(units, begin, tick);
+  }
+
+  doOnDemandGC(tick);
+}
+
+void PageMapping::readUnits(Request &req,
+                            std::map<uint64_t, PAL::Request> &pages,
+                            uint64_t tick) {
+  uint32_t blockIndex;
+  uint32_t pageIndex;
 
-        if (mapping.first < pFTLParam->totalPhysicalBlocks &&
-            mapping.second < pFTLParam->pagesInBlock) {
-          block = blocks.find(mapping.first);
+  for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
+    if (req.ioFlag.test(idx)) {
+      if (table.getMapping(req.lpn, idx, blockIndex, pageIndex)) {
+        auto block = blocks.find(blockIndex);
 
-          // Invalidate current page
-          block->second.invalidate(mapping.second, idx);
+        if (block == blocks.end()) {
+          Logger::panic("Block is not in use");
         }
+
+        block->second.read(pageIndex, idx, tick);
+        addUnit(pages, req, blockIndex, pageIndex, idx);
       }
     }
   }
-  else {
-    // Create empty mapping
-    auto ret = table.insert(
-        {req.lpn, std::vector<std::pair<uint32_t, uint32_t>>(
-                      pFTLParam->ioUnitInPage, {pFTLParam->totalPhysicalBlocks,
-                                                pFTLParam->pagesInBlock})});
+}
 
-    if (!ret.second) {
-      Logger::panic("Failed to insert new mapping");
-    }
+void PageMapping::invalidateUnits(Request &req) {
+  uint32_t blockIndex;
+  uint32_t pageIndex;
 
-    mappingList = ret.first;
+  for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
+    if (req.ioFlag.test(idx)) {
+      if (table.getMapping(req.lpn, idx, blockIndex, pageIndex)) {
+        // Invalidate current page
+        invalidatePage(blocks.find(blockIndex), pageIndex, idx);
+      }
+    }
   }
+}
 
-  // Write data to free block
-  block = blocks.find(getLastFreeBlock());
+void PageMapping::writeUnits(Request &req, uint32_t blockIndex,
+                             uint32_t stream, bool toSLC,
+                             std::map<uint64_t, PAL::Request> &pages,
+                             uint64_t tick, bool sendToPAL) {
+  auto block = blocks.find(blockIndex);
 
   if (block == blocks.end()) {
     Logger::panic("No such block");
@@ -499,75 +1681,230 @@ void PageMapping::writeInternal(Request &req, uint64_t &tick, bool sendToPAL) {
   for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
     if (req.ioFlag.test(idx)) {
       uint32_t pageIndex = block->second.getNextWritePageIndex(idx);
-      auto &mapping = mappingList->second.at(idx);
 
-      beginAt = tick;
+      if (toSLC) {
+        pageIndex = slcNextPage.at(pageIndex);
+      }
 
-      block->second.write(pageIndex, req.lpn, idx, beginAt);
+      block->second.write(pageIndex, req.lpn, idx, tick);
 
       // update mapping to table
-      mapping.first = block->first;
-      mapping.second = pageIndex;
+      table.setMapping(req.lpn, idx, blockIndex, pageIndex);
 
       if (sendToPAL) {
-        palRequest.blockIndex = block->first;
-        palRequest.pageIndex = pageIndex;
-        palRequest.ioFlag.reset();
-        palRequest.ioFlag.set(idx);
+        streamStat.at(toSLC ? stream : blockStream.at(blockIndex))
+            .hostPages++;
 
-        pPAL->write(palRequest, beginAt);
+        addUnit(pages, req, blockIndex, pageIndex, idx);
       }
+    }
+  }
+}
+
+void PageMapping::addUnit(std::map<uint64_t, PAL::Request> &pages,
+                          Request &req, uint32_t blockIndex,
+                          uint32_t pageIndex, uint32_t idx) {
+  uint64_t key = ((uint64_t)blockIndex << 32) | pageIndex;
+  auto iter = pages.find(key);
+
+  if (iter == pages.end()) {
+    iter = pages.emplace(key, PAL::Request(pFTLParam->ioUnitInPage)).first;
+
+    iter->second.reqID = req.reqID;
+    iter->second.reqSubID = req.reqSubID;
+    iter->second.blockIndex = blockIndex;
+    iter->second.pageIndex = pageIndex;
+  }
+
+  iter->second.ioFlag.set(idx);
+}
 
-      finishedAt = MAX(finishedAt, beginAt);
+void PageMapping::submitPages(std::map<uint64_t, PAL::Request> &pages,
+                              bool write, uint64_t &tick,
+                              std::unordered_map<uint64_t, uint64_t> *list) {
+  uint64_t beginAt;
+  uint64_t finishedAt = tick;
+
+  for (auto &iter : pages) {
+    beginAt = tick;
+
+    if (write) {
+      pPAL->write(iter.second, beginAt);
+
+      stat.programmedPages += iter.second.ioFlag.count();
+    }
+    else {
+      pPAL->read(iter.second, beginAt);
+    }
+
+    if (list) {
+      list->emplace(iter.first, beginAt);
     }
+
+    finishedAt = MAX(finishedAt, beginAt);
   }
 
   tick = finishedAt;
+}
+
+void PageMapping::countSLCHostPages(uint64_t pages, uint64_t begin,
+                                    uint64_t tick) {
+  if (stat.slcHostPages == 0) {
+    stat.slcBurstBeginAt = begin;
+  }
+
+  stat.slcHostPages += pages;
+
+  if (stat.slcFullCount == 0) {
+    stat.slcBurstPages += pages;
+    stat.slcBurstEndAt = tick;
+  }
+}
+
+void PageMapping::doOnDemandGC(uint64_t tick) {
+  static const float threshold = conf.readFloat(FTL_GC_THRESHOLD_RATIO);
+  static const uint64_t maxPages = conf.readUint(FTL_GC_MAX_PAGES_PER_REQUEST);
 
-  // GC if needed
-  if (freeBlockRatio() < conf.readFloat(FTL_GC_THRESHOLD_RATIO)) {
-    std::vector<uint32_t> list;
+  if (pendingVictims.size() > 0 || freeBlockRatio() < threshold ||
+      hasStarvingSlot()) {
     uint64_t beginAt = tick;
 
-    selectVictimBlock(list, beginAt);
+    if (pendingVictims.size() == 0) {
+      std::vector<uint32_t> list;
 
-    Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
-                       "GC   | On-demand | %u blocks will be reclaimed",
-                       list.size());
+      selectVictimBlock(list, beginAt);
+
+      Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
+                         "GC   | On-demand | %u blocks will be reclaimed",
+                         list.size());
+
+      stat.gcCount++;
+      stat.reclaimedBlocks += list.size();
+      stat.fgReclaimedBlocks += list.size();
+
+      for (auto &iter : list) {
+        countVictim(blocks.find(iter)->second);
+      }
+
+      if (maxPages == 0) {
+        doGarbageCollection(list, beginAt);
+      }
+      else {
+        // Victims are reclaimed in following steps
+        for (auto &iter : list) {
+          Block &victim = blocks.find(iter)->second;
+
+          victimIndex.at(victim.getDirtyPageCount()).erase(iter);
+          pendingVictims.push_back(iter);
+        }
+
+        gcPageIndex = 0;
+        gcFinishedAt = beginAt;
+      }
+    }
 
-    doGarbageCollection(list, beginAt);
+    if (pendingVictims.size() > 0) {
+      // Finish at once if free blocks are critically low
+      doIncrementalGC(freeBlockRatio() < threshold / 2 ? 0 : maxPages,
+                      beginAt);
+    }
 
     Logger::debugprint(Logger::LOG_FTL_PAGE_MAPPING,
                        "GC   | Done | %" PRIu64 " - %" PRIu64 " (%" PRIu64 ")",
                        tick, beginAt, beginAt - tick);
 
-    stat.gcCount++;
-    stat.reclaimedBlocks += list.size();
+    stat.fgGCTime += beginAt - tick;
+    fgGCLatency.add(beginAt - tick);
   }
 }
 
 void PageMapping::trimInternal(Request &req, uint64_t &tick) {
-  auto mappingList = table.find(req.lpn);
+  uint32_t blockIndex;
+  uint32_t pageIndex;
 
-  if (mappingList != table.end()) {
-    // Do trim
-    for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
-      auto &mapping = mappingList->second.at(idx);
-      auto block = blocks.find(mapping.first);
+  translate(req.lpn, true, tick);
+
+  // Do trim, only on requested units
+  for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
+    if (req.ioFlag.test(idx) &&
+        table.getMapping(req.lpn, idx, blockIndex, pageIndex)) {
+      auto block = blocks.find(blockIndex);
 
       if (block == blocks.end()) {
         Logger::panic("Block is not in use");
       }
 
-      block->second.invalidate(mapping.second, idx);
+      invalidatePage(block, pageIndex, idx);
+
+      // Remove mapping
+      table.resetMapping(req.lpn, idx);
+    }
+  }
+}
+
+void PageMapping::trimRange(LPNRange &range, uint64_t &tick,
+                            std::vector<uint32_t> &list, bool load) {
+  uint64_t end = MIN(range.slpn + range.nlp, table.getLPNCount());
+  std::unordered_map<uint32_t, uint32_t> dirtyPageCount;
+  auto block = blocks.end();
+  uint32_t blockIndex;
+  uint32_t pageIndex;
+
+  list.clear();
+
+  for (uint64_t lpn = range.slpn; lpn < end; lpn++) {
+    // Translation page covers many LPNs, so update it once
+    if (lpn == range.slpn || lpn % entriesInTranslationPage == 0) {
+      if (load) {
+        translate(lpn, true, tick);
+      }
+      else {
+        markTranslationDirty(lpn);
+      }
+    }
+
+    for (uint32_t idx = 0; idx < pFTLParam->ioUnitInPage; idx++) {
+      if (!table.getMapping(lpn, idx, blockIndex, pageIndex)) {
+        continue;
+      }
+
+      // Units of a page are usually in same block
+      if (block == blocks.end() || block->first != blockIndex) {
+        block = blocks.find(blockIndex);
+
+        if (block == blocks.end()) {
+          Logger::panic("Block is not in use");
+        }
+
+        dirtyPageCount.emplace(blockIndex,
+                               block->second.getDirtyPageCount());
+      }
+
+      block->second.invalidate(pageIndex, idx);
+    }
+
+    table.resetMapping(lpn);
+  }
+
+  // Move each block to new bucket once (pending victims are not indexed)
+  list.reserve(dirtyPageCount.size());
+
+  for (auto &iter : dirtyPageCount) {
+    uint32_t after = blocks.find(iter.first)->second.getDirtyPageCount();
+
+    if (iter.second != after &&
+        victimIndex.at(iter.second).erase(iter.first) > 0) {
+      victimIndex.at(after).insert(iter.first);
     }
 
-    // Remove mapping
-    table.erase(mappingList);
+    list.push_back(iter.first);
   }
+
+  std::sort(list.begin(), list.end());
 }
 
-void PageMapping::eraseInternal(PAL::Request &req, uint64_t &tick) {
+void PageMapping::eraseInternal(PAL::Request &req, uint64_t &tick,
+                                bool sendToPAL) {
   static uint64_t threshold = conf.readUint(FTL_BAD_BLOCK_THRESHOLD);
   auto block = blocks.find(req.blockIndex);
 
@@ -584,15 +1921,46 @@ void PageMapping::eraseInternal(PAL::Request &req, uint64_t &tick) {
     Logger::panic("There are valid pages in victim block");
   }
 
+  // Remove block from victim index
+  victimIndex.at(block->second.getDirtyPageCount()).erase(req.blockIndex);
+
   // Erase block
   block->second.erase();
 
-  pPAL->erase(req, tick);
+  if (sendToPAL) {
+    pPAL->erase(req, tick);
+
+    stat.erasedBlocks++;
+  }
+
+  wearLeveling.erase(block->second.getEraseCount(),
+                     block->second.getEraseCount() >= threshold);
 
   // Check erase count
   if (block->second.getEraseCount() < threshold) {
+    // SLC block stays in block list, and goes back to SLC region
+    if (slcBlock.at(req.blockIndex)) {
+      slcFreeBlocks.at(convertBlockIdx(req.blockIndex))
+          .push_back(req.blockIndex);
+
+      return;
+    }
+
     // Insert block to free block list
-    freeBlocks.insert({req.blockIndex, block->second});
+    freeBlockSlots.at(convertBlockIdx(req.blockIndex))
+        .emplace(block->second.getEraseCount(), req.blockIndex);
+    freeBlocks.emplace(req.blockIndex, std::move(block->second));
+  }
+  else if (slcBlock.at(req.blockIndex)) {
+    // Replace retired SLC block with free block of same slot
+    uint32_t slot = convertBlockIdx(req.blockIndex);
+    uint32_t blockIndex = getFreeBlock(slot);
+
+    victimIndex.at(0).erase(blockIndex);
+    blockStream.at(blockIndex) = 0;
+    slcBlock.at(blockIndex) = true;
+    slcBlock.at(req.blockIndex) = false;
+    slcFreeBlocks.at(slot).push_back(blockIndex);
   }
 
   // Remove block from block list
@@ -609,15 +1977,339 @@ void PageMapping::getStats(std::vector<Stats> &list) {
   temp.name = "ftl.page_mapping.reclaimed_blocks";
   temp.desc = "Total reclaimed blocks in GC";
   list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.bg_gc_count";
+  temp.desc = "Total background GC count";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.fg_reclaimed_blocks";
+  temp.desc = "Total reclaimed blocks in foreground GC";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.bg_reclaimed_blocks";
+  temp.desc = "Total reclaimed blocks in background GC";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.fg_gc_time";
+  temp.desc = "Total time spent in foreground GC (ps)";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.bg_gc_time";
+  temp.desc = "Total time spent in background GC (ps)";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.copyback_pages";
+  temp.desc = "Total pages moved by copyback in GC";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.host_pages";
+  temp.desc = "Total pages written by host";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.gc_pages";
+  temp.desc = "Total pages copied out of GC victims";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.programmed_pages";
+  temp.desc = "Total pages programmed to NAND, including GC, wear-leveling, "
+              "folding and translation pages";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.erased_blocks";
+  temp.desc = "Total blocks erased";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.write_amplification";
+  temp.desc = "Programmed pages / host pages (x1000)";
+  list.push_back(temp);
+
+  fgGCLatency.getStats(list, "ftl.page_mapping.fg_gc_latency",
+                       "on-demand GC invocations");
+
+  if (conf.readInt(FTL_GC_MODE) == GC_MODE_2) {
+    bgGCLatency.getStats(list, "ftl.page_mapping.bg_gc_latency",
+                         "blocks reclaimed by background GC");
+  }
+
+  for (uint32_t i = 0; i < 10; i++) {
+    temp.name = "ftl.page_mapping.victim_valid.hist" + std::to_string(i);
+    temp.desc = "GC victims with " + std::to_string(i * 10) + " - " +
+                std::to_string(i * 10 + 10) + "% valid pages";
+    list.push_back(temp);
+  }
+
+  temp.name = "ftl.page_mapping.erase_count.min";
+  temp.desc = "Minimum erase count of usable blocks";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.erase_count.max";
+  temp.desc = "Maximum erase count of usable blocks";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.erase_count.retired";
+  temp.desc = "Total blocks retired by erase threshold";
+  list.push_back(temp);
+
+  for (uint32_t i = 0; i < wearLeveling.getBucketCount(); i++) {
+    uint32_t from;
+    uint32_t to;
+
+    wearLeveling.getBucketRange(i, from, to);
+
+    temp.name = "ftl.page_mapping.erase_count.hist" + std::to_string(i);
+    temp.desc = "Usable blocks erased " + std::to_string(from) + " - " +
+                std::to_string(to) + " times";
+    list.push_back(temp);
+  }
+
+  if (bWearLeveling) {
+    temp.name = "ftl.page_mapping.wear_leveling.count";
+    temp.desc = "Total cold blocks moved by static wear-leveling";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.wear_leveling.pages";
+    temp.desc = "Total pages moved by static wear-leveling";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.wear_leveling.time";
+    temp.desc = "Total time spent in static wear-leveling (ps)";
+    list.push_back(temp);
+  }
+
+  for (uint32_t i = 0; i < streamCount; i++) {
+    std::string prefix = "ftl.page_mapping.stream" + std::to_string(i) + ".";
+
+    temp.name = prefix + "host_pages";
+    temp.desc = "Total pages written by host to stream";
+    list.push_back(temp);
+
+    temp.name = prefix + "gc_pages";
+    temp.desc = "Total pages moved by GC out of blocks of stream";
+    list.push_back(temp);
+
+    if (bWearLeveling) {
+      temp.name = prefix + "wear_leveling_pages";
+      temp.desc = "Total pages moved by wear-leveling out of blocks of stream";
+      list.push_back(temp);
+    }
+
+    temp.name = prefix + "write_amplification";
+    temp.desc = "(host + GC + wear-leveling pages) / host pages of stream "
+                "(x1000)";
+    list.push_back(temp);
+  }
+
+  if (bDemandMapping) {
+    temp.name = "ftl.page_mapping.dftl.hit";
+    temp.desc = "Total lookups hit in cached translation pages";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.dftl.miss";
+    temp.desc = "Total lookups missed in cached translation pages";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.dftl.writeback";
+    temp.desc = "Total dirty translation pages written back on eviction";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.dftl.gc_update";
+    temp.desc = "Total uncached translation pages updated by GC";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.dftl.gc_pages";
+    temp.desc = "Total translation pages moved by GC";
+    list.push_back(temp);
+  }
+
+  if (bExtentMapping) {
+    temp.name = "ftl.page_mapping.extent.count";
+    temp.desc = "Current number of extents in mapping table";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.extent.page_entries";
+    temp.desc = "Current number of per-page entries in mapping table";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.extent.unit_entries";
+    temp.desc = "Current number of per-unit entries in mapping table";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.extent.table_size";
+    temp.desc = "Bytes used by mapping table";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.extent.compression_ratio";
+    temp.desc = "Size of dense mapping table / bytes used (x1000)";
+    list.push_back(temp);
+  }
+
+  if (slcBlocksPerSlot > 0) {
+    temp.name = "ftl.page_mapping.slc.host_pages";
+    temp.desc = "Total host pages written to SLC cache";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.slc.folded_pages";
+    temp.desc = "Total pages folded from SLC cache to normal blocks";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.slc.folded_blocks";
+    temp.desc = "Total SLC blocks folded";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.slc.fg_fold_time";
+    temp.desc = "Total time host writes waited for folding (ps)";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.slc.bg_fold_time";
+    temp.desc = "Total time spent on folding in idle time (ps)";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.slc.full_count";
+    temp.desc = "Total writes arrived when SLC cache is full";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.slc.burst_pages";
+    temp.desc = "Host pages written before SLC cache is full";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.slc.burst_time";
+    temp.desc = "Time until SLC cache is full (ps)";
+    list.push_back(temp);
+
+    temp.name = "ftl.page_mapping.slc.burst_bandwidth";
+    temp.desc = "Host write bandwidth until SLC cache is full (MB/s)";
+    list.push_back(temp);
+  }
+
+  if (bDynamicAllocation) {
+    temp.name = "ftl.page_mapping.reordered_allocations";
+    temp.desc = "Total writes allocated out of static slot order";
+    list.push_back(temp);
+  }
+
+  temp.name = "ftl.page_mapping.gc_read.count";
+  temp.desc = "Total read requests arrived during GC";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.gc_read.latency_avg";
+  temp.desc = "Average latency of read requests arrived during GC (ps)";
+  list.push_back(temp);
+
+  temp.name = "ftl.page_mapping.gc_read.latency_max";
+  temp.desc = "Maximum latency of read requests arrived during GC (ps)";
+  list.push_back(temp);
 }
 
 void PageMapping::getStatValues(std::vector<uint64_t> &values) {
+  std::vector<uint64_t> histogram;
+  uint64_t hostPages = 0;
+
   values.push_back(stat.gcCount);
   values.push_back(stat.reclaimedBlocks);
+  values.push_back(stat.bgGCCount);
+  values.push_back(stat.fgReclaimedBlocks);
+  values.push_back(stat.bgReclaimedBlocks);
+  values.push_back(stat.fgGCTime);
+  values.push_back(stat.bgGCTime);
+  values.push_back(stat.copybackPages);
+
+  for (auto &iter : streamStat) {
+    hostPages += iter.hostPages;
+  }
+
+  values.push_back(hostPages);
+  values.push_back(stat.gcPages);
+  values.push_back(stat.programmedPages);
+  values.push_back(stat.erasedBlocks);
+  values.push_back(hostPages > 0 ? stat.programmedPages * 1000 / hostPages
+                                 : 0);
+
+  fgGCLatency.getStatValues(values);
+
+  if (conf.readInt(FTL_GC_MODE) == GC_MODE_2) {
+    bgGCLatency.getStatValues(values);
+  }
+
+  values.insert(values.end(), stat.victimValid, stat.victimValid + 10);
+  values.push_back(wearLeveling.getMinEraseCount());
+  values.push_back(wearLeveling.getMaxEraseCount());
+  values.push_back(wearLeveling.getRetiredBlockCount());
+
+  wearLeveling.getHistogram(histogram);
+  values.insert(values.end(), histogram.begin(), histogram.end());
+
+  if (bWearLeveling) {
+    values.push_back(stat.wlCount);
+    values.push_back(stat.wlPages);
+    values.push_back(stat.wlTime);
+  }
+
+  for (auto &iter : streamStat) {
+    values.push_back(iter.hostPages);
+    values.push_back(iter.gcPages);
+
+    if (bWearLeveling) {
+      values.push_back(iter.wlPages);
+    }
+
+    values.push_back(iter.hostPages > 0
+                         ? (iter.hostPages + iter.gcPages + iter.wlPages) *
+                               1000 / iter.hostPages
+                         : 0);
+  }
+
+  if (bDemandMapping) {
+    values.push_back(stat.cmtHit);
+    values.push_back(stat.cmtMiss);
+    values.push_back(stat.cmtWriteback);
+    values.push_back(stat.gcTranslationUpdates);
+    values.push_back(stat.gcTranslationPages);
+  }
+
+  if (bExtentMapping) {
+    uint64_t size = table.getTableSize();
+
+    values.push_back(table.getExtentCount());
+    values.push_back(table.getPageEntryCount());
+    values.push_back(table.getUnitEntryCount());
+    values.push_back(size);
+    values.push_back(size > 0 ? table.getDenseTableSize() * 1000 / size : 0);
+  }
+
+  if (slcBlocksPerSlot > 0) {
+    uint64_t burstTime = stat.slcBurstEndAt - stat.slcBurstBeginAt;
+
+    values.push_back(stat.slcHostPages);
+    values.push_back(stat.slcFoldedPages);
+    values.push_back(stat.slcFoldedBlocks);
+    values.push_back(stat.slcFgFoldTime);
+    values.push_back(stat.slcBgFoldTime);
+    values.push_back(stat.slcFullCount);
+    values.push_back(stat.slcBurstPages);
+    values.push_back(burstTime);
+    values.push_back(
+        burstTime > 0
+            ? (uint64_t)((double)stat.slcBurstPages * pFTLParam->pageSize /
+                         pFTLParam->ioUnitInPage * 1000000. / burstTime)
+            : 0);
+  }
+
+  if (bDynamicAllocation) {
+    values.push_back(stat.reorderedAllocations);
+  }
+
+  values.push_back(stat.gcReadCount);
+  values.push_back(stat.gcReadCount > 0
+                       ? stat.gcReadLatency / stat.gcReadCount
+                       : 0);
+  values.push_back(stat.gcReadLatencyMax);
 }
 
 void PageMapping::resetStats() {
   memset(&stat, 0, sizeof(stat));
+  memset(streamStat.data(), 0, sizeof(StreamStat) * streamCount);
+  fgGCLatency.reset();
+  bgGCLatency.reset();
 }
 
 }  // namespace FTL
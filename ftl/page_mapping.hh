@@ -21,12 +21,21 @@
 #define __FTL_PAGE_MAPPING__
 
 #include <cinttypes>
+#include <deque>
+#include <map>
+#include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "dram/abstract_dram.hh"
 #include "ftl/abstract_ftl.hh"
 #include "ftl/common/block.hh"
-#include "ftl/common/latency.hh"
+#include "ftl/common/firmware.hh"
+#include "ftl/common/histogram.hh"
+#include "ftl/common/mapping_table.hh"
+#include "ftl/common/translation_cache.hh"
+#include "ftl/common/wear_leveling.hh"
 #include "ftl/ftl.hh"
 #include "pal/pal.hh"
 
@@ -37,46 +46,191 @@ namespace FTL {
 class PageMapping : public AbstractFTL {
  private:
   PAL::PAL *pPAL;
+  DRAM::AbstractDRAM *pDRAM;
+  Firmware *pFirmware;
 
   Config &conf;
   Parameter *pFTLParam;
-  Latency latency;
 
-  std::unordered_map<uint64_t, std::vector<std::pair<uint32_t, uint32_t>>>
-      table;
+  bool bExtentMapping;
+  bool bDynamicAllocation;  //!< Select slot by PAL die availability
+  MappingTable table;
+
+  // Demand-based mapping (DFTL)
+  // Translation pages are written to one more stream after host streams
+  bool bDemandMapping;
+  uint64_t entriesInTranslationPage;  //!< # LPNs in one translation page
+  MappingTable gtd;                   //!< Global translation directory
+  TranslationCache cmt;               //!< Cached translation pages
+  std::set<uint64_t> gcTranslationUpdates;
+
   std::unordered_map<uint32_t, Block> blocks;
   std::unordered_map<uint32_t, Block> freeBlocks;
+
+  // Free blocks of each parallelism slot, ordered by (erase count, index)
+  std::vector<std::set<std::pair<uint32_t, uint32_t>>> freeBlockSlots;
+  // Static wear-leveling moves cold data to one more stream after others,
+  // which takes most erased free blocks
+  bool bWearLeveling;
+  uint32_t wlStream;
+  WearLeveling wearLeveling;
+  // Free blocks being written, indexed by [stream][parallelism slot]
+  uint32_t streamCount;
   std::vector<uint32_t> lastFreeBlock;
-  uint32_t lastFreeBlockIndex;
+  std::vector<uint32_t> lastFreeBlockIndex;
+  std::vector<uint8_t> blockStream;
+  std::vector<bool> openBlock;  //!< Listed in lastFreeBlock
+
+  // Per-LPN update counter for hot/cold separation
+  std::vector<uint8_t> updateCount;
+  uint64_t updatesInEpoch;
+
+  // In-use blocks, bucketed by dirty page count (victim candidates)
+  std::vector<std::unordered_set<uint32_t>> victimIndex;
 
   bool bReclaimMore;
 
+  // Background GC
+  bool bBackgroundGC;
+  uint64_t lastRequestFinishedAt;
+  uint64_t lastGCFinishedAt;
+  uint64_t bgReclaimLatency;
+
+  // Incremental GC
+  std::deque<uint32_t> pendingVictims;
+  uint32_t gcPageIndex;
+  uint64_t gcFinishedAt;
+  uint64_t gcBusyUntil;
+
+  // Pseudo-SLC write cache, programmed only in LSB pages
+  // Blocks of this region stay in blocks, and are never GC victims
+  uint32_t slcBlocksPerSlot;
+  std::vector<uint32_t> slcNextPage;  //!< First LSB page at or after index
+  std::vector<bool> slcBlock;
+  std::vector<uint32_t> slcFrontier;  //!< Block being written, per slot
+  uint32_t slcFrontierIndex;
+  std::vector<std::deque<uint32_t>> slcFreeBlocks;
+  std::vector<std::deque<uint32_t>> slcFullBlocks;  //!< Oldest first
+  uint64_t lastFoldFinishedAt;
+  uint64_t foldLatency;
+
   struct {
     uint64_t gcCount;
     uint64_t reclaimedBlocks;
+    uint64_t bgGCCount;
+    uint64_t fgReclaimedBlocks;
+    uint64_t bgReclaimedBlocks;
+    uint64_t fgGCTime;
+    uint64_t bgGCTime;
+    uint64_t gcReadCount;
+    uint64_t gcReadLatency;
+    uint64_t gcReadLatencyMax;
+    uint64_t copybackPages;
+    uint64_t cmtHit;
+    uint64_t cmtMiss;
+    uint64_t cmtWriteback;
+    uint64_t gcTranslationUpdates;
+    uint64_t gcTranslationPages;
+    uint64_t slcHostPages;
+    uint64_t slcFoldedPages;
+    uint64_t slcFoldedBlocks;
+    uint64_t slcFgFoldTime;
+    uint64_t slcBgFoldTime;
+    uint64_t slcBurstPages;    //!< Host pages until region is full
+    uint64_t slcBurstBeginAt;  //!< First host write to region
+    uint64_t slcBurstEndAt;    //!< Last write before region is full
+    uint64_t slcFullCount;     //!< # writes waited for folding
+    uint64_t reorderedAllocations;
+    uint64_t wlCount;
+    uint64_t wlPages;
+    uint64_t wlTime;
+    uint64_t programmedPages;  //!< I/O units programmed to NAND, for any cause
+    uint64_t gcPages;          //!< I/O units copied out of GC victims
+    uint64_t erasedBlocks;
+    uint64_t victimValid[10];  //!< GC victims by valid page ratio, per 10%
   } stat;
 
+  Histogram fgGCLatency;  //!< Per on-demand GC invocation
+  Histogram bgGCLatency;  //!< Per block reclaimed in idle time
+
+  struct StreamStat {
+    uint64_t hostPages;
+    uint64_t gcPages;
+    uint64_t wlPages;
+  };
+
+  std::vector<StreamStat> streamStat;
+
   float freeBlockRatio();
+  bool isStarving(uint32_t);
+  bool hasStarvingSlot();
   uint32_t convertBlockIdx(uint32_t);
-  uint32_t getFreeBlock(uint32_t);
-  uint32_t getLastFreeBlock();
+  uint32_t getFreeBlock(uint32_t, bool = false);
+  uint32_t getLastFreeBlock(uint32_t, uint64_t);
+  uint32_t getLastFreeBlockAt(uint32_t, uint32_t);
+  uint32_t getWriteStream(uint64_t);
+  void invalidatePage(std::unordered_map<uint32_t, Block>::iterator, uint32_t,
+                      uint32_t);
   void selectVictimBlock(std::vector<uint32_t> &, uint64_t &);
-  void doGarbageCollection(std::vector<uint32_t> &, uint64_t &);
+  void getVictimBlocks(std::vector<uint32_t> &, uint64_t, uint64_t &);
+  void countGCPages(uint32_t, uint64_t);
+  bool migratePage(std::unordered_map<uint32_t, Block>::iterator, uint32_t,
+                   uint64_t, uint64_t &, bool = true, uint32_t = 0);
+  void countVictim(Block &);
+  void doGarbageCollection(std::vector<uint32_t> &, uint64_t &, bool = true);
+  void doIncrementalGC(uint64_t, uint64_t &);
+  void doBackgroundGC(uint64_t);
+  void doWearLeveling(uint64_t);
+  void precondition(uint64_t, uint64_t);
+
+  uint32_t getSLCBlock(uint64_t &);
+  void foldSLCBlock(uint32_t, uint64_t &);
+  void doBackgroundFolding(uint64_t);
+
+  void translate(uint64_t, bool, uint64_t &);
+  void markTranslationDirty(uint64_t);
+  void readTranslationPage(uint64_t, uint64_t &);
+  void writeTranslationPage(uint64_t, uint64_t &, bool = true);
+  bool migrateTranslationPage(std::unordered_map<uint32_t, Block>::iterator,
+                              uint32_t, uint64_t, uint64_t &, bool);
+  void flushTranslationUpdates(uint64_t &, bool);
 
   void readInternal(Request &, uint64_t &);
+  void readInternal(std::vector<Request> &, uint64_t &);
   void writeInternal(Request &, uint64_t &, bool = true);
+  void writeInternal(std::vector<Request> &, std::vector<uint64_t> &,
+                     uint64_t &);
+  void doOnDemandGC(uint64_t);
+
+  // Units sharing one physical page, keyed by (block << 32 | page), are sent
+  // to PAL as one multi-unit request
+  void readUnits(Request &, std::map<uint64_t, PAL::Request> &, uint64_t);
+  void invalidateUnits(Request &);
+  void writeUnits(Request &, uint32_t, uint32_t, bool,
+                  std::map<uint64_t, PAL::Request> &, uint64_t, bool);
+  void addUnit(std::map<uint64_t, PAL::Request> &, Request &, uint32_t,
+               uint32_t, uint32_t);
+  void submitPages(std::map<uint64_t, PAL::Request> &, bool, uint64_t &,
+                   std::unordered_map<uint64_t, uint64_t> * = nullptr);
+  void countSLCHostPages(uint64_t, uint64_t, uint64_t);
   void trimInternal(Request &, uint64_t &);
-  void eraseInternal(PAL::Request &, uint64_t &);
+  void trimRange(LPNRange &, uint64_t &, std::vector<uint32_t> &, bool);
+  void eraseInternal(PAL::Request &, uint64_t &, bool = true);
 
  public:
-  PageMapping(Parameter *, PAL::PAL *, ConfigReader *);
+  PageMapping(Parameter *, PAL::PAL *, DRAM::AbstractDRAM *, Firmware *,
+              ConfigReader *);
   ~PageMapping();
 
   bool initialize() override;
 
   void read(Request &, uint64_t &) override;
   void write(Request &, uint64_t &) override;
+  void read(std::vector<Request> &, uint64_t &) override;
+  void write(std::vector<Request> &, std::vector<uint64_t> &,
+             uint64_t &) override;
   void trim(Request &, uint64_t &) override;
+  void trim(LPNRange &, uint64_t &) override;
 
   void format(LPNRange &, uint64_t &) override;
 
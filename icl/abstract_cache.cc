@@ -24,10 +24,24 @@ namespace SimpleSSD {
 namespace ICL {
 
 Line::_Line()
-    : tag(0), lastAccessed(0), insertedAt(0), dirty(false), valid(false) {}
+    : tag(0),
+      lastAccessed(0),
+      insertedAt(0),
+      dirty(false),
+      valid(false),
+      prefetched(false),
+      prev(nullptr),
+      next(nullptr) {}
 
 Line::_Line(uint64_t t, bool d)
-    : tag(t), lastAccessed(0), insertedAt(0), dirty(d), valid(true) {}
+    : tag(t),
+      lastAccessed(0),
+      insertedAt(0),
+      dirty(d),
+      valid(true),
+      prefetched(false),
+      prev(nullptr),
+      next(nullptr) {}
 
 AbstractCache::AbstractCache(ConfigReader *c, FTL::FTL *f,
                              DRAM::AbstractDRAM *d)
@@ -35,6 +35,11 @@ typedef struct _Line {
   uint64_t insertedAt;
   bool dirty;
   bool valid;
+  bool prefetched;  //!< Read ahead and not accessed yet
+
+  // Links of dirty line list
+  _Line *prev;
+  _Line *next;
 
   _Line();
   _Line(uint64_t, bool);
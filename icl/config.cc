@@ -34,6 +34,11 @@ const char NAME_CACHE_SIZE[] = "CacheSize";
 const char NAME_WAY_SIZE[] = "CacheWaySize";
 const char NAME_PREFETCH_COUNT[] = "ReadPrefetchCount";
 const char NAME_PREFETCH_RATIO[] = "ReadPrefetchRatio";
+const char NAME_PREFETCH_STREAM[] = "ReadPrefetchStreamCount";
+const char NAME_PREFETCH_MAX_DEPTH[] = "ReadPrefetchMaxDepth";
+const char NAME_USE_DESTAGE[] = "EnableDestage";
+const char NAME_DESTAGE_LOW_WATERMARK[] = "DestageLowWatermark";
+const char NAME_DESTAGE_HIGH_WATERMARK[] = "DestageHighWatermark";
 
 Config::Config() {
   readCaching = false;
@@ -44,6 +49,11 @@ Config::Config() {
   cacheWaySize = 1;
   prefetchCount = 1;
   prefetchRatio = 0.5;
+  prefetchStream = 4;
+  prefetchMaxDepth = 1;
+  destage = false;
+  destageLowWatermark = 0.4f;
+  destageHighWatermark = 0.7f;
 }
 
 bool Config::setConfig(const char *name, const char *value) {
@@ -64,6 +74,12 @@ bool Config::setConfig(const char *name, const char *value) {
   else if (MATCH_NAME(NAME_PREFETCH_RATIO)) {
     prefetchRatio = strtof(value, nullptr);
   }
+  else if (MATCH_NAME(NAME_PREFETCH_STREAM)) {
+    prefetchStream = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_PREFETCH_MAX_DEPTH)) {
+    prefetchMaxDepth = strtoul(value, nullptr, 10);
+  }
   else if (MATCH_NAME(NAME_EVICT_POLICY)) {
     evictPolicy = (EVICT_POLICY)strtoul(value, nullptr, 10);
   }
@@ -73,6 +89,15 @@ bool Config::setConfig(const char *name, const char *value) {
   else if (MATCH_NAME(NAME_WAY_SIZE)) {
     cacheWaySize = strtoul(value, nullptr, 10);
   }
+  else if (MATCH_NAME(NAME_USE_DESTAGE)) {
+    destage = convertBool(value);
+  }
+  else if (MATCH_NAME(NAME_DESTAGE_LOW_WATERMARK)) {
+    destageLowWatermark = strtof(value, nullptr);
+  }
+  else if (MATCH_NAME(NAME_DESTAGE_HIGH_WATERMARK)) {
+    destageHighWatermark = strtof(value, nullptr);
+  }
   else {
     ret = false;
   }
@@ -87,6 +112,23 @@ void Config::update() {
   if (prefetchRatio <= 0.f) {
     Logger::panic("Invalid ReadPrefetchRatio");
   }
+  if (prefetchStream == 0) {
+    Logger::panic("Invalid ReadPrefetchStreamCount");
+  }
+  if (prefetchMaxDepth == 0) {
+    Logger::panic("Invalid ReadPrefetchMaxDepth");
+  }
+
+  if (destage) {
+    if (destageLowWatermark < 0.f) {
+      Logger::panic("Invalid DestageLowWatermark");
+    }
+
+    if (destageHighWatermark <= destageLowWatermark ||
+        destageHighWatermark > 1.f) {
+      Logger::panic("Invalid DestageHighWatermark");
+    }
+  }
 }
 
 int64_t Config::readInt(uint32_t idx) {
@@ -114,6 +156,12 @@ uint64_t Config::readUint(uint32_t idx) {
     case ICL_PREFETCH_COUNT:
       ret = prefetchCount;
       break;
+    case ICL_PREFETCH_STREAM:
+      ret = prefetchStream;
+      break;
+    case ICL_PREFETCH_MAX_DEPTH:
+      ret = prefetchMaxDepth;
+      break;
   }
 
   return ret;
@@ -126,6 +174,12 @@ float Config::readFloat(uint32_t idx) {
     case ICL_PREFETCH_RATIO:
       ret = prefetchRatio;
       break;
+    case ICL_DESTAGE_LOW_WATERMARK:
+      ret = destageLowWatermark;
+      break;
+    case ICL_DESTAGE_HIGH_WATERMARK:
+      ret = destageHighWatermark;
+      break;
   }
 
   return ret;
@@ -144,6 +198,9 @@ bool Config::readBoolean(uint32_t idx) {
     case ICL_USE_READ_PREFETCH:
       ret = readPrefetch;
       break;
+    case ICL_USE_DESTAGE:
+      ret = destage;
+      break;
   }
 
   return ret;
@@ -33,27 +33,40 @@ typedef enum {
   ICL_USE_READ_PREFETCH,
   ICL_PREFETCH_COUNT,
   ICL_PREFETCH_RATIO,
+  ICL_PREFETCH_STREAM,
+  ICL_PREFETCH_MAX_DEPTH,
   ICL_EVICT_POLICY,
   ICL_CACHE_SIZE,
   ICL_WAY_SIZE,
+
+  /* Destage config */
+  ICL_USE_DESTAGE,
+  ICL_DESTAGE_LOW_WATERMARK,
+  ICL_DESTAGE_HIGH_WATERMARK,
 } ICL_CONFIG;
 
 typedef enum {
   POLICY_RANDOM,               //!< Select way in random
   POLICY_FIFO,                 //!< Select way that lastly inserted
   POLICY_LEAST_RECENTLY_USED,  //!< Select way that least recently used
+  POLICY_TWO_QUEUE,            //!< Scan resistant 2Q with ghost list
 } EVICT_POLICY;
 
 class Config : public BaseConfig {
  private:
-  bool readCaching;          //!< Default: false
-  bool writeCaching;         //!< Default: true
-  bool readPrefetch;         //!< Default: false
-  EVICT_POLICY evictPolicy;  //!< Default: POLICY_LEAST_RECENTLY_USED
-  uint64_t cacheWaySize;     //!< Default: 1
-  uint64_t cacheSize;        //!< Default: 33554432 (32MiB)
-  uint64_t prefetchCount;    //!< Default: 1
-  float prefetchRatio;       //!< Default: 0.5
+  bool readCaching;            //!< Default: false
+  bool writeCaching;           //!< Default: true
+  bool readPrefetch;           //!< Default: false
+  EVICT_POLICY evictPolicy;    //!< Default: POLICY_LEAST_RECENTLY_USED
+  uint64_t cacheWaySize;       //!< Default: 1
+  uint64_t cacheSize;          //!< Default: 33554432 (32MiB)
+  uint64_t prefetchCount;      //!< Default: 1
+  float prefetchRatio;         //!< Default: 0.5
+  uint64_t prefetchStream;     //!< Default: 4
+  uint64_t prefetchMaxDepth;   //!< Default: 1
+  bool destage;                //!< Default: false
+  float destageLowWatermark;   //!< Default: 0.4
+  float destageHighWatermark;  //!< Default: 0.7
 
  public:
   Config();
@@ -22,7 +22,10 @@
 #include <algorithm>
 #include <cstddef>
 #include <limits>
+#include <list>
+#include <unordered_map>
 
+#include "ftl/common/firmware.hh"
 #include "log/trace.hh"
 #include "util/algorithm.hh"
 
@@ -40,13 +43,28 @@ GenericCache::GenericCache(ConfigReader *c, FTL::FTL *f, DRAM::AbstractDRAM *d)
       parallelIO(f->getInfo()->pageCountToMaxPerf),
       lineCountInMaxIO(parallelIO * lineCountInSuperPage),
       waySize(c->iclConfig.readUint(ICL_WAY_SIZE)),
+      totalLogicalLines(f->getInfo()->totalLogicalBlocks *
+                        f->getInfo()->pagesInBlock * lineCountInSuperPage),
       prefetchIOCount(c->iclConfig.readUint(ICL_PREFETCH_COUNT)),
       prefetchIORatio(c->iclConfig.readFloat(ICL_PREFETCH_RATIO)),
+      prefetchMaxDepth(c->iclConfig.readUint(ICL_PREFETCH_MAX_DEPTH) *
+                       lineCountInMaxIO),
       useReadCaching(c->iclConfig.readBoolean(ICL_USE_READ_CACHE)),
       useWriteCaching(c->iclConfig.readBoolean(ICL_USE_WRITE_CACHE)),
       useReadPrefetch(c->iclConfig.readBoolean(ICL_USE_READ_PREFETCH)),
+      useDestage(useWriteCaching &&
+                 c->iclConfig.readBoolean(ICL_USE_DESTAGE)),
+      destageLowWatermark(
+          c->iclConfig.readFloat(ICL_DESTAGE_LOW_WATERMARK)),
+      destageHighWatermark(
+          c->iclConfig.readFloat(ICL_DESTAGE_HIGH_WATERMARK)),
       gen(rd()),
-      dist(std::uniform_int_distribution<>(0, waySize - 1)) {
+      dist(std::uniform_int_distribution<>(0, waySize - 1)),
+      lines(nullptr),
+      dirtyCount(0),
+      bDestage(false),
+      lastRequestFinishedAt(0),
+      lastDestageFinishedAt(0) {
   uint64_t cacheSize = c->iclConfig.readUint(ICL_CACHE_SIZE);
 
   if (!useReadCaching && !useWriteCaching) {
@@ -71,22 +89,30 @@ GenericCache::GenericCache(ConfigReader *c, FTL::FTL *f, DRAM::AbstractDRAM *d)
       "CREATE  | line count in super page %u | line count in max I/O %u",
       lineCountInSuperPage, lineCountInMaxIO);
 
+  lines = new Line[(uint64_t)setSize * waySize]();
   cacheData.resize(setSize);
 
   for (uint32_t i = 0; i < setSize; i++) {
-    cacheData[i] = new Line[waySize]();
+    cacheData[i] = lines + (uint64_t)i * waySize;
   }
 
+  tagIndex.reserve((uint64_t)setSize * waySize);
+
   evictData.resize(lineCountInSuperPage);
 
   for (uint32_t i = 0; i < lineCountInSuperPage; i++) {
     evictData[i] = (Line **)calloc(parallelIO, sizeof(Line *));
   }
 
-  lastRequest.reqID = 1;
-  prefetchEnabled = false;
-  hitCounter = 0;
-  accessCounter = 0;
+  dirtyList.resize(lineCountInMaxIO, {nullptr, nullptr, 0});
+
+  streams.resize(c->iclConfig.readUint(ICL_PREFETCH_STREAM));
+  streamAccessCounter = 0;
+
+  for (auto &stream : streams) {
+    memset(&stream, 0, sizeof(PrefetchStream));
+    stream.nextAddr = std::numeric_limits<uint64_t>::max();
+  }
 
   // Set evict policy functional
   policy = (EVICT_POLICY)c->iclConfig.readInt(ICL_EVICT_POLICY);
@@ -96,16 +122,22 @@ GenericCache::GenericCache(ConfigReader *c, FTL::FTL *f, DRAM::AbstractDRAM *d)
       evictFunction = [this](uint32_t setIdx, uint64_t &tick) -> uint32_t {
         return dist(gen);
       };
-      compareFunction = [this](Line *a, Line *b) -> Line * {
-        if (a && b) {
-          return dist(gen) > waySize / 2 ? a : b;
-        }
-        else if (a || b) {
-          return a ? a : b;
-        }
-        else {
-          return nullptr;
+      selectFunction = [this](DirtyList &list, uint64_t &tick) -> Line * {
+        Line *line = list.head;
+
+        tick += CACHE_DELAY * 8;
+
+        if (list.size > 1) {
+          uint64_t count =
+              std::uniform_int_distribution<uint64_t>(0, list.size - 1)(gen);
+
+          for (; count > 0; count--) {
+            tick += CACHE_DELAY * 8;
+            line = line->next;
+          }
         }
+
+        return line;
       };
 
       break;
@@ -127,21 +159,10 @@ GenericCache::GenericCache(ConfigReader *c, FTL::FTL *f, DRAM::AbstractDRAM *d)
 
         return wayIdx;
       };
-      compareFunction = [](Line *a, Line *b) -> Line * {
-        if (a && b) {
-          if (a->insertedAt < b->insertedAt) {
-            return a;
-          }
-          else {
-            return b;
-          }
-        }
-        else if (a || b) {
-          return a ? a : b;
-        }
-        else {
-          return nullptr;
-        }
+      selectFunction = [](DirtyList &list, uint64_t &tick) -> Line * {
+        tick += CACHE_DELAY * 8;
+
+        return list.head;
       };
 
       break;
@@ -163,21 +184,56 @@ GenericCache::GenericCache(ConfigReader *c, FTL::FTL *f, DRAM::AbstractDRAM *d)
 
         return wayIdx;
       };
-      compareFunction = [](Line *a, Line *b) -> Line * {
-        if (a && b) {
-          if (a->lastAccessed < b->lastAccessed) {
-            return a;
+      selectFunction = [](DirtyList &list, uint64_t &tick) -> Line * {
+        tick += CACHE_DELAY * 8;
+
+        return list.head;
+      };
+
+      break;
+    case POLICY_TWO_QUEUE:
+      // Sizes from 2Q paper, 25% of lines for A1in and 50% for A1out
+      a1inSize = MAX(waySize / 4, 1);
+      a1outSize = MAX(waySize / 2, 1);
+
+      wayLink.resize((uint64_t)setSize * waySize,
+                     {waySize, waySize, QUEUE_NONE});
+      a1in.resize(setSize, {waySize, waySize, 0});
+      am.resize(setSize, {waySize, waySize, 0});
+      a1out.resize(setSize);
+
+      evictFunction = [this](uint32_t setIdx, uint64_t &tick) -> uint32_t {
+        uint32_t wayIdx;
+
+        // Only head of queue is read
+        tick += CACHE_DELAY * 8;
+
+        if (a1in[setIdx].size > a1inSize || am[setIdx].size == 0) {
+          auto &ghost = a1out[setIdx];
+
+          wayIdx = a1in[setIdx].head;
+
+          // Remember evicted tag to detect re-reference
+          if (a1outIndex.count(cacheData[setIdx][wayIdx].tag) == 0) {
+            ghost.push_back(cacheData[setIdx][wayIdx].tag);
+            a1outIndex.emplace(ghost.back(), std::prev(ghost.end()));
           }
-          else {
-            return b;
+
+          if (ghost.size() > a1outSize) {
+            a1outIndex.erase(ghost.front());
+            ghost.pop_front();
           }
         }
-        else if (a || b) {
-          return a ? a : b;
-        }
         else {
-          return nullptr;
+          wayIdx = am[setIdx].head;
         }
+
+        return wayIdx;
+      };
+      selectFunction = [](DirtyList &list, uint64_t &tick) -> Line * {
+        tick += CACHE_DELAY * 8;
+
+        return list.head;
       };
 
       break;
@@ -191,11 +247,9 @@ GenericCache::GenericCache(ConfigReader *c, FTL::FTL *f, DRAM::AbstractDRAM *d)
 }
 
 GenericCache::~GenericCache() {
-  for (uint32_t i = 0; i < setSize; i++) {
-    delete[] cacheData[i];
-  }
+  delete[] lines;
 
-  for (uint32_t i = 0; i < lineCountInSuperPage; i++) {
+  for (uint32_t i = 0; i < evictData.size(); i++) {
     free(evictData[i]);
   }
 }
@@ -233,87 +287,348 @@ uint32_t GenericCache::getEmptyWay(uint32_t setIdx, uint64_t &tick) {
   return retIdx;
 }
 
-uint32_t GenericCache::getValidWay(uint64_t lca, uint64_t &tick) {
-  uint32_t setIdx = calcSetIndex(lca);
-  uint32_t wayIdx;
+GenericCache::DirtyList &GenericCache::getDirtyList(uint64_t lca) {
+  uint32_t row, col;
 
-  for (wayIdx = 0; wayIdx < waySize; wayIdx++) {
-    Line &line = cacheData[setIdx][wayIdx];
+  calcIOPosition(lca, row, col);
 
-    tick += CACHE_DELAY * 8;
-    // pDRAM->read(MAKE_META_ADDR(setIdx, wayIdx, offsetof(Line, tag)), 8,
-    // tick);
+  return dirtyList[row * parallelIO + col];
+}
 
-    if (line.valid && line.tag == lca) {
-      break;
+void GenericCache::setLine(Line *line, bool valid, bool dirty, uint64_t tag) {
+  uint64_t pos = line - lines;
+  bool reindex = line->valid && (!valid || line->tag != tag);
+
+  pos = (pos / waySize) << 32 | (pos % waySize);
+
+  if (reindex) {
+    auto range = tagIndex.equal_range(line->tag);
+
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      if (iter->second == pos) {
+        tagIndex.erase(iter);
+
+        break;
+      }
     }
   }
 
-  return wayIdx;
+  // Unlink from dirty list
+  if (line->valid && line->dirty) {
+    DirtyList &list = getDirtyList(line->tag);
+
+    if (line->prev) {
+      line->prev->next = line->next;
+    }
+    else {
+      list.head = line->next;
+    }
+
+    if (line->next) {
+      line->next->prev = line->prev;
+    }
+    else {
+      list.tail = line->prev;
+    }
+
+    line->prev = nullptr;
+    line->next = nullptr;
+    list.size--;
+    dirtyCount--;
+  }
+
+  if (valid && (reindex || !line->valid)) {
+    tagIndex.emplace(tag, pos);
+  }
+
+  // Prefetched data leaves cache without access
+  if (line->prefetched && (!valid || line->tag != tag)) {
+    line->prefetched = false;
+
+    shrinkPrefetch(line->tag);
+  }
+
+  if (policy == POLICY_TWO_QUEUE && (reindex || (valid && !line->valid))) {
+    uint32_t setIdx = pos >> 32;
+    uint32_t wayIdx = pos & 0xFFFFFFFF;
+
+    if (line->valid) {
+      popQueue(setIdx, wayIdx);
+    }
+
+    if (valid) {
+      auto iter = a1outIndex.find(tag);
+
+      // Accessed again after eviction from A1in
+      if (iter != a1outIndex.end()) {
+        a1out[setIdx].erase(iter->second);
+        a1outIndex.erase(iter);
+
+        pushQueue(setIdx, wayIdx, QUEUE_AM);
+      }
+      else {
+        pushQueue(setIdx, wayIdx, QUEUE_A1IN);
+      }
+    }
+  }
+
+  line->valid = valid;
+  line->dirty = dirty;
+  line->tag = tag;
+
+  // Updated line goes to the tail
+  if (valid && dirty) {
+    DirtyList &list = getDirtyList(tag);
+
+    line->prev = list.tail;
+
+    if (list.tail) {
+      list.tail->next = line;
+    }
+    else {
+      list.head = line;
+    }
+
+    list.tail = line;
+    list.size++;
+    dirtyCount++;
+  }
+}
+
+void GenericCache::touchLine(Line *line) {
+  if (policy == POLICY_TWO_QUEUE) {
+    uint64_t pos = line - lines;
+    uint32_t setIdx = pos / waySize;
+    uint32_t wayIdx = pos % waySize;
+
+    // Access in A1in does not promote line, as it may be a scan
+    if (wayLink[pos].queue == QUEUE_AM) {
+      popQueue(setIdx, wayIdx);
+      pushQueue(setIdx, wayIdx, QUEUE_AM);
+    }
+  }
+
+  // Only LRU order changes on access
+  if ((policy == POLICY_LEAST_RECENTLY_USED || policy == POLICY_TWO_QUEUE) &&
+      line->valid && line->dirty) {
+    setLine(line, true, true, line->tag);
+  }
+}
+
+void GenericCache::pushQueue(uint32_t setIdx, uint32_t wayIdx,
+                             QUEUE_TYPE type) {
+  WayQueue &queue = type == QUEUE_AM ? am[setIdx] : a1in[setIdx];
+  WayLink *link = wayLink.data() + (uint64_t)setIdx * waySize;
+
+  link[wayIdx].prev = queue.tail;
+  link[wayIdx].next = waySize;
+  link[wayIdx].queue = type;
+
+  if (queue.tail != waySize) {
+    link[queue.tail].next = wayIdx;
+  }
+  else {
+    queue.head = wayIdx;
+  }
+
+  queue.tail = wayIdx;
+  queue.size++;
 }
 
-void GenericCache::checkPrefetch(Request &req) {
-  if (lastRequest.reqID == req.reqID) {
-    lastRequest.range = req.range;
-    lastRequest.offset = req.offset;
-    lastRequest.length = req.length;
+void GenericCache::popQueue(uint32_t setIdx, uint32_t wayIdx) {
+  WayLink *link = wayLink.data() + (uint64_t)setIdx * waySize;
+  WayQueue &queue = link[wayIdx].queue == QUEUE_AM ? am[setIdx] : a1in[setIdx];
 
+  if (link[wayIdx].queue == QUEUE_NONE) {
     return;
   }
 
-  if (lastRequest.range.slpn * lineSize + lastRequest.offset +
-          lastRequest.length ==
-      req.range.slpn * lineSize + req.offset) {
-    if (!prefetchEnabled) {
-      hitCounter++;
-      accessCounter += req.length;
+  if (link[wayIdx].prev != waySize) {
+    link[link[wayIdx].prev].next = link[wayIdx].next;
+  }
+  else {
+    queue.head = link[wayIdx].next;
+  }
+
+  if (link[wayIdx].next != waySize) {
+    link[link[wayIdx].next].prev = link[wayIdx].prev;
+  }
+  else {
+    queue.tail = link[wayIdx].prev;
+  }
+
+  link[wayIdx].prev = waySize;
+  link[wayIdx].next = waySize;
+  link[wayIdx].queue = QUEUE_NONE;
+  queue.size--;
+}
+
+uint32_t GenericCache::getValidWay(uint64_t lca, uint64_t &tick) {
+  uint32_t setIdx = calcSetIndex(lca);
+  uint32_t wayIdx = waySize;
+  auto range = tagIndex.equal_range(lca);
+
+  // First matching way, as ways are probed in order
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if ((iter->second >> 32) == setIdx) {
+      wayIdx = MIN(wayIdx, (uint32_t)iter->second);
+    }
+  }
+
+  // Metadata access of all probed ways
+  tick += CACHE_DELAY * 8 * (wayIdx == waySize ? waySize : wayIdx + 1);
+  // pDRAM->read(MAKE_META_ADDR(setIdx, wayIdx, offsetof(Line, tag)), 8,
+  // tick);
 
-      if (hitCounter >= prefetchIOCount &&
-          (float)accessCounter / superPageSize >= prefetchIORatio) {
-        prefetchEnabled = true;
+  return wayIdx;
+}
+
+// Stream of request, when read-ahead is enabled on it
+GenericCache::PrefetchStream *GenericCache::checkPrefetch(Request &req) {
+  uint64_t addr = req.range.slpn * lineSize + req.offset;
+  PrefetchStream *stream = nullptr;
+
+  for (auto &iter : streams) {
+    // Rest of request already checked
+    if (iter.reqID == req.reqID) {
+      iter.nextAddr = addr + req.length;
+
+      return iter.enabled ? &iter : nullptr;
+    }
+  }
+
+  for (auto &iter : streams) {
+    if (iter.nextAddr == addr) {
+      stream = &iter;
+
+      break;
+    }
+  }
+
+  if (stream) {
+    if (!stream->enabled) {
+      stream->hitCounter++;
+      stream->accessCounter += req.length;
+
+      if (stream->hitCounter >= prefetchIOCount &&
+          (float)stream->accessCounter / superPageSize >= prefetchIORatio) {
+        stream->enabled = true;
       }
     }
   }
   else {
-    prefetchEnabled = false;
-    hitCounter = 0;
-    accessCounter = 0;
+    // Replace least recently used stream, keeping sequential ones from
+    // being pushed out by random requests
+    stream = &streams.front();
+
+    for (auto &iter : streams) {
+      bool seq = iter.hitCounter > 0;
+      bool victimSeq = stream->hitCounter > 0;
+
+      if (seq < victimSeq ||
+          (seq == victimSeq && iter.lastAccessed < stream->lastAccessed)) {
+        stream = &iter;
+      }
+    }
+
+    stream->prefetchedUntil = 0;
+    stream->depth = lineCountInMaxIO;
+    stream->hitCounter = 0;
+    stream->accessCounter = 0;
+    stream->enabled = false;
   }
 
-  lastRequest = req;
+  stream->reqID = req.reqID;
+  stream->nextAddr = addr + req.length;
+  stream->lastAccessed = ++streamAccessCounter;
+
+  return stream->enabled ? stream : nullptr;
+}
+
+void GenericCache::shrinkPrefetch(uint64_t lca) {
+  stat.prefetchWasted++;
+
+  // Read-ahead of stream went too far
+  for (auto &stream : streams) {
+    if (lca < stream.prefetchedUntil &&
+        lca + stream.depth >= stream.prefetchedUntil) {
+      stream.depth = MAX(stream.depth / 2, lineCountInSuperPage);
+    }
+  }
+}
+
+void GenericCache::writeBack(std::vector<uint64_t> &lcas,
+                             std::vector<uint64_t> &finishedAt,
+                             uint64_t &tick) {
+  std::vector<FTL::Request> list;
+  std::vector<uint64_t> listFinishedAt;
+  std::unordered_map<uint64_t, uint32_t> listIndex;
+
+  // Lines of the same super page are merged into one FTL request, and all
+  // requests are written as one batch
+  for (auto &lca : lcas) {
+    uint64_t lpn = lca / lineCountInSuperPage;
+    auto iter = listIndex.emplace(lpn, list.size());
+
+    if (iter.second) {
+      list.emplace_back(lineCountInSuperPage);
+      list.back().lpn = lpn;
+    }
+
+    list.at(iter.first->second).ioFlag.set(lca % lineCountInSuperPage);
+  }
+
+  if (list.size() > 0) {
+    pFTL->write(list, listFinishedAt, tick);
+  }
+
+  // Each line is written when its super page is
+  finishedAt.clear();
+
+  for (auto &lca : lcas) {
+    finishedAt.push_back(
+        listFinishedAt.at(listIndex[lca / lineCountInSuperPage]));
+  }
 }
 
 void GenericCache::evictCache(uint64_t tick) {
-  FTL::Request reqInternal(lineCountInSuperPage);
-  uint64_t beginAt;
+  std::vector<uint64_t> lcas;
+  std::vector<uint64_t> writtenAt;
   uint64_t finishedAt = tick;
 
   Logger::debugprint(Logger::LOG_ICL_GENERIC_CACHE, "----- | Begin eviction");
 
   for (uint32_t row = 0; row < lineCountInSuperPage; row++) {
     for (uint32_t col = 0; col < parallelIO; col++) {
-      beginAt = tick;
-
       if (evictData[row][col] == nullptr) {
         continue;
       }
 
       if (evictData[row][col]->valid && evictData[row][col]->dirty) {
-        reqInternal.lpn = evictData[row][col]->tag / lineCountInSuperPage;
-        reqInternal.ioFlag.reset();
-        reqInternal.ioFlag.set(row);
+        lcas.push_back(evictData[row][col]->tag);
+      }
+    }
+  }
+
+  writeBack(lcas, writtenAt, finishedAt);
 
-        pFTL->write(reqInternal, beginAt);
+  for (uint32_t row = 0, i = 0; row < lineCountInSuperPage; row++) {
+    for (uint32_t col = 0; col < parallelIO; col++) {
+      if (evictData[row][col] == nullptr) {
+        continue;
       }
 
-      evictData[row][col]->insertedAt = beginAt;
-      evictData[row][col]->lastAccessed = beginAt;
-      evictData[row][col]->valid = false;
-      evictData[row][col]->dirty = false;
-      evictData[row][col]->tag = 0;
-      evictData[row][col] = nullptr;
+      // Written lines wait only for their own super page
+      uint64_t evictedAt = tick;
+
+      if (evictData[row][col]->valid && evictData[row][col]->dirty) {
+        evictedAt = writtenAt.at(i++);
+      }
 
-      finishedAt = MAX(finishedAt, beginAt);
+      evictData[row][col]->insertedAt = evictedAt;
+      evictData[row][col]->lastAccessed = evictedAt;
+      setLine(evictData[row][col], false, false, 0);
+      evictData[row][col] = nullptr;
     }
   }
 
@@ -323,6 +638,159 @@ void GenericCache::evictCache(uint64_t tick) {
                      tick, finishedAt, finishedAt - tick);
 }
 
+void GenericCache::doDestage(uint64_t tick) {
+  uint64_t lineCount = (uint64_t)setSize * waySize;
+  uint64_t beginAt = MAX(lastRequestFinishedAt, lastDestageFinishedAt);
+  uint64_t destaged = 0;
+
+  if (!useDestage) {
+    return;
+  }
+
+  if (!bDestage && dirtyCount > lineCount * destageHighWatermark) {
+    bDestage = true;
+  }
+
+  // Issue one stripe at a time while device is idle. Stripe may overlap
+  // with following requests, which wait for NAND in FTL.
+  while (bDestage && beginAt < tick) {
+    std::vector<Line *> stripe;
+    std::vector<uint64_t> lcas;
+    std::vector<uint64_t> writtenAt;
+    uint64_t finishedAt = beginAt;
+
+    // Pick one dirty line per I/O position
+    for (auto &list : dirtyList) {
+      if (list.size > 0) {
+        Line *line = selectFunction(list, finishedAt);
+
+        stripe.push_back(line);
+        lcas.push_back(line->tag);
+      }
+    }
+
+    writeBack(lcas, writtenAt, finishedAt);
+
+    // Lines stay in cache as clean
+    for (auto &line : stripe) {
+      setLine(line, true, false, line->tag);
+    }
+
+    stat.destageTime += finishedAt - beginAt;
+    stat.destagedLines += stripe.size();
+    stat.destageCount++;
+    beginAt = finishedAt;
+    destaged += stripe.size();
+
+    if (dirtyCount <= lineCount * destageLowWatermark) {
+      bDestage = false;
+    }
+  }
+
+  if (destaged > 0) {
+    Logger::debugprint(Logger::LOG_ICL_GENERIC_CACHE,
+                       "----- | Destage | %" PRIu64 " lines | %" PRIu64
+                       " - %" PRIu64,
+                       destaged,
+                       MAX(lastRequestFinishedAt, lastDestageFinishedAt),
+                       beginAt);
+
+    lastDestageFinishedAt = beginAt;
+  }
+}
+
+void GenericCache::readLines(Request &req, uint64_t beginLCA, uint64_t endLCA,
+                             uint64_t &tick) {
+  FTL::Request reqInternal(lineCountInSuperPage, req);
+  std::vector<std::pair<uint64_t, uint64_t>> readList;
+  std::vector<uint64_t> writeList;
+  std::vector<Line *> victimList;
+  uint32_t setIdx;
+  uint32_t wayIdx;
+  uint64_t dramAt;
+  uint64_t beginAt = tick;
+  uint64_t finishedAt = tick;
+
+  endLCA = MIN(endLCA, totalLogicalLines);
+
+  for (uint64_t lca = beginLCA; lca < endLCA; lca++) {
+    // Check cache
+    if (getValidWay(lca, beginAt) != waySize) {
+      continue;
+    }
+
+    // Find way to write data read from NVM
+    setIdx = calcSetIndex(lca);
+    wayIdx = getEmptyWay(setIdx, tick);
+
+    if (wayIdx == waySize) {
+      wayIdx = evictFunction(setIdx, tick);
+
+      // We need to write back dirty data before overwrite
+      if (cacheData[setIdx][wayIdx].dirty) {
+        writeList.push_back(cacheData[setIdx][wayIdx].tag);
+        victimList.push_back(cacheData[setIdx] + wayIdx);
+      }
+    }
+
+    cacheData[setIdx][wayIdx].insertedAt = tick;
+    cacheData[setIdx][wayIdx].lastAccessed = tick;
+    setLine(cacheData[setIdx] + wayIdx, true, false, lca);
+
+    if (lca != req.range.slpn) {
+      cacheData[setIdx][wayIdx].prefetched = true;
+      stat.prefetchLines++;
+    }
+
+    readList.push_back({lca, ((uint64_t)setIdx << 32) | wayIdx});
+  }
+
+  if (writeList.size() > 0) {
+    std::vector<uint64_t> writtenAt;
+    uint64_t writeBackAt = tick;
+
+    writeBack(writeList, writtenAt, writeBackAt);
+
+    for (uint64_t i = 0; i < victimList.size(); i++) {
+      victimList.at(i)->insertedAt = writtenAt.at(i);
+    }
+  }
+
+  for (auto &iter : readList) {
+    Line *pLine = &cacheData[iter.second >> 32][iter.second & 0xFFFFFFFF];
+
+    // Read data
+    reqInternal.lpn = iter.first / lineCountInSuperPage;
+    reqInternal.ioFlag.reset();
+    reqInternal.ioFlag.set(iter.first % lineCountInSuperPage);
+
+    beginAt = tick;  // Ignore cache metadata access
+    pFTL->read(reqInternal, beginAt);
+
+    // DRAM delay
+    dramAt = pLine->insertedAt;
+    pDRAM->read(pLine, lineSize, dramAt);
+
+    // Set cache data
+    beginAt = MAX(beginAt, dramAt);
+
+    pLine->insertedAt = beginAt;
+    pLine->lastAccessed = beginAt;
+
+    if (iter.first == req.range.slpn) {
+      finishedAt = beginAt;
+    }
+
+    Logger::debugprint(Logger::LOG_ICL_GENERIC_CACHE,
+                       "READ  | Cache miss at (%u, %u) | %" PRIu64
+                       " - %" PRIu64 " (%" PRIu64 ")",
+                       iter.second >> 32, iter.second & 0xFFFFFFFF, tick,
+                       beginAt, beginAt - tick);
+  }
+
+  tick = finishedAt;
+}
+
 // True when hit
 bool GenericCache::read(Request &req, uint64_t &tick) {
   bool ret = false;
@@ -331,14 +799,19 @@ bool GenericCache::read(Request &req, uint64_t &tick) {
                      "READ  | REQ %7u-%-4u | LCA %" PRIu64 " | SIZE %" PRIu64,
                      req.reqID, req.reqSubID, req.range.slpn, req.length);
 
+  doDestage(tick);
+
   if (useReadCaching) {
     uint32_t setIdx = calcSetIndex(req.range.slpn);
     uint32_t wayIdx;
+    PrefetchStream *stream = nullptr;
 
     if (useReadPrefetch) {
-      checkPrefetch(req);
+      stream = checkPrefetch(req);
     }
 
+    pFTL->getFirmware()->execute(FTL::FIRMWARE_CACHE_LOOKUP, 1, tick);
+
     wayIdx = getValidWay(req.range.slpn, tick);
 
     // Do we have valid data?
@@ -352,6 +825,7 @@ bool GenericCache::read(Request &req, uint64_t &tick) {
 
       // Update last accessed time
       cacheData[setIdx][wayIdx].lastAccessed = tick;
+      touchLine(cacheData[setIdx] + wayIdx);
 
       // DRAM access
       pDRAM->read(&cacheData[setIdx][wayIdx], req.length, tick);
@@ -361,90 +835,39 @@ bool GenericCache::read(Request &req, uint64_t &tick) {
                          " - %" PRIu64 " (%" PRIu64 ")",
                          setIdx, wayIdx, arrived, tick, tick - arrived);
 
-      ret = true;
-    }
-    // We should read data from NVM
-    else {
-      FTL::Request reqInternal(lineCountInSuperPage, req);
-      std::vector<std::pair<uint64_t, uint64_t>> readList;
-      uint32_t row, col;  // Variable for I/O position (IOFlag)
-      uint64_t dramAt;
-      uint64_t beginLCA, endLCA;
-      uint64_t beginAt, finishedAt = tick;
-
-      if (prefetchEnabled) {
-        beginLCA = req.range.slpn;
-        endLCA = beginLCA + lineCountInMaxIO;
-      }
-      else {
-        beginLCA = req.range.slpn;
-        endLCA = beginLCA + 1;
-      }
+      if (cacheData[setIdx][wayIdx].prefetched) {
+        cacheData[setIdx][wayIdx].prefetched = false;
+        stat.prefetchHit++;
 
-      for (uint64_t lca = beginLCA; lca < endLCA; lca++) {
-        // Check cache
-        if (getValidWay(lca, beginAt) != waySize) {
-          continue;
+        if (stream) {
+          stream->depth = MIN(stream->depth + 1, prefetchMaxDepth);
         }
-
-        // Find way to write data read from NVM
-        setIdx = calcSetIndex(lca);
-        wayIdx = getEmptyWay(setIdx, tick);
-
-        if (wayIdx == waySize) {
-          wayIdx = evictFunction(setIdx, tick);
-
-          if (cacheData[setIdx][wayIdx].dirty) {
-            // We need to evict data before write
-            calcIOPosition(cacheData[setIdx][wayIdx].tag, row, col);
-            evictData[row][col] = cacheData[setIdx] + wayIdx;
-          }
-        }
-
-        cacheData[setIdx][wayIdx].insertedAt = tick;
-        cacheData[setIdx][wayIdx].lastAccessed = tick;
-        cacheData[setIdx][wayIdx].valid = true;
-        cacheData[setIdx][wayIdx].dirty = false;
-
-        readList.push_back({lca, ((uint64_t)setIdx << 32) | wayIdx});
       }
 
-      evictCache(tick);
-
-      for (auto &iter : readList) {
-        Line *pLine = &cacheData[iter.second >> 32][iter.second & 0xFFFFFFFF];
-
-        // Read data
-        reqInternal.lpn = iter.first / lineCountInSuperPage;
-        reqInternal.ioFlag.reset();
-        reqInternal.ioFlag.set(iter.first % lineCountInSuperPage);
+      // Read ahead in background when half of window is consumed
+      if (stream &&
+          stream->prefetchedUntil < req.range.slpn + 1 + stream->depth / 2) {
+        uint64_t beginLCA = MAX(stream->prefetchedUntil, req.range.slpn + 1);
+        uint64_t endLCA = req.range.slpn + 1 + stream->depth;
 
-        beginAt = tick;  // Ignore cache metadata access
-        pFTL->read(reqInternal, beginAt);
+        stream->prefetchedUntil = endLCA;
 
-        // DRAM delay
-        dramAt = pLine->insertedAt;
-        pDRAM->read(pLine, lineSize, dramAt);
-
-        // Set cache data
-        beginAt = MAX(beginAt, dramAt);
-
-        pLine->insertedAt = beginAt;
-        pLine->lastAccessed = beginAt;
-        pLine->tag = iter.first;
+        readLines(req, beginLCA, endLCA, arrived);
+      }
 
-        if (pLine->tag == req.range.slpn) {
-          finishedAt = beginAt;
-        }
+      ret = true;
+    }
+    // We should read data from NVM
+    else {
+      uint64_t endLCA = req.range.slpn + 1;
 
-        Logger::debugprint(Logger::LOG_ICL_GENERIC_CACHE,
-                           "READ  | Cache miss at (%u, %u) | %" PRIu64
-                           " - %" PRIu64 " (%" PRIu64 ")",
-                           iter.second >> 32, iter.second & 0xFFFFFFFF, tick,
-                           beginAt, beginAt - tick);
+      // Read ahead together
+      if (stream) {
+        endLCA += stream->depth;
+        stream->prefetchedUntil = MAX(stream->prefetchedUntil, endLCA);
       }
 
-      tick = finishedAt;
+      readLines(req, req.range.slpn, endLCA, tick);
     }
   }
   else {
@@ -453,6 +876,8 @@ bool GenericCache::read(Request &req, uint64_t &tick) {
     pFTL->read(reqInternal, tick);
   }
 
+  lastRequestFinishedAt = MAX(lastRequestFinishedAt, tick);
+
   stat.request[0]++;
 
   if (ret) {
@@ -470,10 +895,14 @@ bool GenericCache::write(Request &req, uint64_t &tick) {
                      "WRITE | REQ %7u-%-4u | LCA %" PRIu64 " | SIZE %" PRIu64,
                      req.reqID, req.reqSubID, req.range.slpn, req.length);
 
+  doDestage(tick);
+
   if (useWriteCaching) {
     uint32_t setIdx = calcSetIndex(req.range.slpn);
     uint32_t wayIdx;
 
+    pFTL->getFirmware()->execute(FTL::FIRMWARE_CACHE_LOOKUP, 1, tick);
+
     wayIdx = getValidWay(req.range.slpn, tick);
 
     // Can we update old data?
@@ -488,7 +917,9 @@ bool GenericCache::write(Request &req, uint64_t &tick) {
       // Update last accessed time
       cacheData[setIdx][wayIdx].insertedAt = tick;
       cacheData[setIdx][wayIdx].lastAccessed = tick;
-      cacheData[setIdx][wayIdx].dirty = true;
+      touchLine(cacheData[setIdx] + wayIdx);
+      setLine(cacheData[setIdx] + wayIdx, true, true,
+              cacheData[setIdx][wayIdx].tag);
 
       // DRAM access
       pDRAM->read(&cacheData[setIdx][wayIdx], req.length, tick);
@@ -515,37 +946,42 @@ bool GenericCache::write(Request &req, uint64_t &tick) {
         // Update last accessed time
         cacheData[setIdx][wayIdx].insertedAt = tick;
         cacheData[setIdx][wayIdx].lastAccessed = tick;
-        cacheData[setIdx][wayIdx].valid = true;
-        cacheData[setIdx][wayIdx].dirty = true;
-        cacheData[setIdx][wayIdx].tag = req.range.slpn;
+        setLine(cacheData[setIdx] + wayIdx, true, true, req.range.slpn);
 
         // DRAM access
         pDRAM->read(&cacheData[setIdx][wayIdx], req.length, tick);
 
         ret = true;
       }
-      // We have to flush
+      // We have to evict
       else {
-        uint32_t row, col;  // Variable for I/O position (IOFlag)
-
-        for (setIdx = 0; setIdx < setSize; setIdx++) {
-          for (wayIdx = 0; wayIdx < waySize; wayIdx++) {
-            if (cacheData[setIdx][wayIdx].valid &&
-                cacheData[setIdx][wayIdx].dirty) {
-              calcIOPosition(cacheData[setIdx][wayIdx].tag, row, col);
-
-              evictData[row][col] = compareFunction(evictData[row][col],
-                                                    cacheData[setIdx] + wayIdx);
+        Line *victim = cacheData[setIdx] + evictFunction(setIdx, tick);
+
+        // Flush a stripe of dirty lines including victim
+        if (victim->dirty) {
+          uint32_t row, col;  // Variable for I/O position (IOFlag)
+
+          calcIOPosition(victim->tag, row, col);
+          evictData[row][col] = victim;
+
+          // Pick one dirty line per remaining I/O position
+          for (row = 0; row < lineCountInSuperPage; row++) {
+            for (col = 0; col < parallelIO; col++) {
+              if (evictData[row][col] == nullptr) {
+                evictData[row][col] =
+                    selectFunction(dirtyList[row * parallelIO + col], tick);
+              }
             }
           }
-        }
-
-        tick += CACHE_DELAY * setSize * waySize * 8;
 
-        evictCache(tick);
+          evictCache(tick);
+        }
+        // Clean line can be dropped
+        else {
+          setLine(victim, false, false, victim->tag);
+        }
 
         // Update cacheline of current request
-        setIdx = calcSetIndex(req.range.slpn);
         wayIdx = getEmptyWay(setIdx, tick);
 
         if (wayIdx == waySize) {
@@ -558,9 +994,7 @@ bool GenericCache::write(Request &req, uint64_t &tick) {
         // Update cache data
         cacheData[setIdx][wayIdx].insertedAt = tick;
         cacheData[setIdx][wayIdx].lastAccessed = tick;
-        cacheData[setIdx][wayIdx].valid = true;
-        cacheData[setIdx][wayIdx].dirty = true;
-        cacheData[setIdx][wayIdx].tag = req.range.slpn;
+        setLine(cacheData[setIdx] + wayIdx, true, true, req.range.slpn);
       }
 
       Logger::debugprint(Logger::LOG_ICL_GENERIC_CACHE,
@@ -575,6 +1009,8 @@ bool GenericCache::write(Request &req, uint64_t &tick) {
     pFTL->write(reqInternal, tick);
   }
 
+  lastRequestFinishedAt = MAX(lastRequestFinishedAt, tick);
+
   stat.request[1]++;
 
   if (ret) {
@@ -611,7 +1047,9 @@ bool GenericCache::flush(Request &req, uint64_t &tick) {
       }
 
       // Invalidate
-      cacheData[setIdx][wayIdx].valid = false;
+      setLine(cacheData[setIdx] + wayIdx, false,
+              cacheData[setIdx][wayIdx].dirty,
+              cacheData[setIdx][wayIdx].tag);
 
       ret = true;
     }
@@ -624,31 +1062,95 @@ bool GenericCache::flush(Request &req, uint64_t &tick) {
 bool GenericCache::trim(Request &req, uint64_t &tick) {
   bool ret = false;
   FTL::Request reqInternal(lineCountInSuperPage);
+  LPNRange range;
+  uint64_t lca = req.range.slpn;
+  uint64_t end = req.range.slpn + req.range.nlp;
+  uint64_t finishedAt = tick;
 
   Logger::debugprint(Logger::LOG_ICL_GENERIC_CACHE,
-                     "TRIM  | REQ %7u-%-4u | LCA %" PRIu64 " | SIZE %" PRIu64,
-                     req.reqID, req.reqSubID, req.range.slpn, req.length);
+                     "TRIM  | REQ %7u-%-4u | LCA %" PRIu64 " + %" PRIu64
+                     " | SIZE %" PRIu64,
+                     req.reqID, req.reqSubID, req.range.slpn, req.range.nlp,
+                     req.length);
 
   if (useReadCaching || useWriteCaching) {
-    uint32_t setIdx = calcSetIndex(req.range.slpn);
-    uint32_t wayIdx;
+    if (req.range.nlp > (uint64_t)setSize * waySize) {
+      std::vector<uint64_t> list;
 
-    // Check cache that we have data for corresponding LBA
-    wayIdx = getValidWay(req.range.slpn, tick);
+      // Range is larger than cache, so find cached lines of it instead
+      for (auto &iter : tagIndex) {
+        if (iter.first >= lca && iter.first < end) {
+          list.push_back(iter.second);
+        }
+      }
 
-    if (wayIdx != waySize) {
-      // Invalidate
-      cacheData[setIdx][wayIdx].valid = false;
+      for (auto &pos : list) {
+        Line *line = cacheData[pos >> 32] + (uint32_t)pos;
+
+        // Invalidate
+        setLine(line, false, line->dirty, line->tag);
+      }
+
+      // One probe pass over all ways
+      finishedAt += CACHE_DELAY * 8 * waySize;
     }
+    else {
+      for (uint64_t i = lca; i < end; i++) {
+        uint32_t setIdx = calcSetIndex(i);
+        uint32_t wayIdx;
+        uint64_t beginAt = tick;
+
+        // Check cache that we have data for corresponding LBA
+        wayIdx = getValidWay(i, beginAt);
+
+        if (wayIdx != waySize) {
+          // Invalidate
+          setLine(cacheData[setIdx] + wayIdx, false,
+                  cacheData[setIdx][wayIdx].dirty,
+                  cacheData[setIdx][wayIdx].tag);
+        }
+
+        // Lines are probed in parallel
+        finishedAt = MAX(finishedAt, beginAt);
+      }
+    }
+
+    tick = finishedAt;
   }
 
   reqInternal.reqID = req.reqID;
   reqInternal.reqSubID = req.reqSubID;
-  reqInternal.lpn = req.range.slpn / lineCountInSuperPage;
-  reqInternal.ioFlag.set(req.range.slpn % lineCountInSuperPage);
 
-  // we have to flush this
-  pFTL->trim(reqInternal, tick);
+  // Unaligned head and tail are trimmed by I/O unit, and whole super pages
+  // between them by one range
+  while (lca < end) {
+    uint64_t lpn = lca / lineCountInSuperPage;
+    uint64_t next = (lpn + 1) * lineCountInSuperPage;
+    uint64_t beginAt = tick;
+
+    if (lca % lineCountInSuperPage == 0 && next <= end) {
+      range.slpn = lpn;
+      range.nlp = end / lineCountInSuperPage - lpn;
+
+      pFTL->trim(range, beginAt);
+
+      lca = (range.slpn + range.nlp) * lineCountInSuperPage;
+    }
+    else {
+      reqInternal.lpn = lpn;
+      reqInternal.ioFlag.reset();
+
+      for (; lca < MIN(next, end); lca++) {
+        reqInternal.ioFlag.set(lca % lineCountInSuperPage);
+      }
+
+      pFTL->trim(reqInternal, beginAt);
+    }
+
+    finishedAt = MAX(finishedAt, beginAt);
+  }
+
+  tick = finishedAt;
 
   return ret;
 }
@@ -666,7 +1168,9 @@ void GenericCache::format(LPNRange &range, uint64_t &tick) {
 
       if (wayIdx != waySize) {
         // Invalidate
-        cacheData[setIdx][wayIdx].valid = false;
+        setLine(cacheData[setIdx] + wayIdx, false,
+                cacheData[setIdx][wayIdx].dirty,
+                cacheData[setIdx][wayIdx].tag);
       }
     }
   }
@@ -696,6 +1200,46 @@ void GenericCache::getStats(std::vector<Stats> &list) {
   temp.name = "icl.generic_cache.write.to_cache";
   temp.desc = "Write requests that served to cache";
   list.push_back(temp);
+
+  temp.name = "icl.generic_cache.prefetch.lines";
+  temp.desc = "Total lines read ahead";
+  list.push_back(temp);
+
+  temp.name = "icl.generic_cache.prefetch.hit";
+  temp.desc = "Read ahead lines accessed by host";
+  list.push_back(temp);
+
+  temp.name = "icl.generic_cache.prefetch.wasted";
+  temp.desc = "Read ahead lines evicted without access";
+  list.push_back(temp);
+
+  temp.name = "icl.generic_cache.prefetch.accuracy";
+  temp.desc = "Ratio of read ahead lines accessed (unit: 0.01%)";
+  list.push_back(temp);
+
+  temp.name = "icl.generic_cache.prefetch.coverage";
+  temp.desc = "Ratio of read misses avoided by read ahead (unit: 0.01%)";
+  list.push_back(temp);
+
+  temp.name = "icl.generic_cache.dirty_ratio";
+  temp.desc = "Ratio of dirty lines in cache (unit: 0.01%)";
+  list.push_back(temp);
+
+  temp.name = "icl.generic_cache.destage.count";
+  temp.desc = "Total stripes written back in idle time";
+  list.push_back(temp);
+
+  temp.name = "icl.generic_cache.destage.lines";
+  temp.desc = "Total lines written back in idle time";
+  list.push_back(temp);
+
+  temp.name = "icl.generic_cache.destage.time";
+  temp.desc = "Total time spent on destage";
+  list.push_back(temp);
+
+  temp.name = "icl.generic_cache.destage.throughput";
+  temp.desc = "Destage throughput (unit: bytes/s)";
+  list.push_back(temp);
 }
 
 void GenericCache::getStatValues(std::vector<uint64_t> &values) {
@@ -703,6 +1247,31 @@ void GenericCache::getStatValues(std::vector<uint64_t> &values) {
   values.push_back(stat.cache[0]);
   values.push_back(stat.request[1]);
   values.push_back(stat.cache[1]);
+  values.push_back(stat.prefetchLines);
+  values.push_back(stat.prefetchHit);
+  values.push_back(stat.prefetchWasted);
+  values.push_back(stat.prefetchLines > 0
+                       ? stat.prefetchHit * 10000 / stat.prefetchLines
+                       : 0);
+  values.push_back(
+      stat.prefetchHit > 0
+          ? stat.prefetchHit * 10000 /
+                (stat.prefetchHit + stat.request[0] - stat.cache[0])
+          : 0);
+  values.push_back(
+      lines ? dirtyCount * 10000 / ((uint64_t)setSize * waySize) : 0);
+  values.push_back(stat.destageCount);
+  values.push_back(stat.destagedLines);
+  values.push_back(stat.destageTime);
+
+  // Tick is in picoseconds
+  if (stat.destageTime > 0) {
+    values.push_back((uint64_t)((double)stat.destagedLines * lineSize * 1e12 /
+                                stat.destageTime));
+  }
+  else {
+    values.push_back(0);
+  }
 }
 
 void GenericCache::resetStats() {
@@ -21,7 +21,9 @@
 #define __ICL_GENERIC_CACHE__
 
 #include <functional>
+#include <list>
 #include <random>
+#include <unordered_map>
 #include <vector>
 
 #include "icl/abstract_cache.hh"
@@ -32,6 +34,41 @@ namespace ICL {
 
 class GenericCache : public AbstractCache {
  private:
+  typedef struct {
+    Line *head;  //!< Next line to evict
+    Line *tail;
+    uint64_t size;
+  } DirtyList;
+
+  typedef struct {
+    uint32_t reqID;            //!< Last request of stream
+    uint64_t nextAddr;         //!< Byte address where stream continues
+    uint64_t prefetchedUntil;  //!< End LCA of issued read-ahead
+    uint64_t depth;            //!< Read-ahead depth in lines
+    uint64_t lastAccessed;
+    uint32_t hitCounter;
+    uint64_t accessCounter;
+    bool enabled;
+  } PrefetchStream;
+
+  typedef enum : uint8_t {
+    QUEUE_NONE,
+    QUEUE_A1IN,  //!< FIFO of lines accessed once
+    QUEUE_AM,    //!< LRU of lines accessed again
+  } QUEUE_TYPE;
+
+  typedef struct {
+    uint32_t head;  //!< Way index, waySize when empty
+    uint32_t tail;
+    uint32_t size;
+  } WayQueue;
+
+  typedef struct {
+    uint32_t prev;
+    uint32_t next;
+    QUEUE_TYPE queue;
+  } WayLink;
+
   const uint32_t lineCountInSuperPage;
   const uint32_t superPageSize;
   const uint32_t lineSize;
@@ -39,42 +76,86 @@ class GenericCache : public AbstractCache {
   const uint32_t lineCountInMaxIO;
   uint32_t setSize;
   uint32_t waySize;
+  const uint64_t totalLogicalLines;
 
   const uint32_t prefetchIOCount;
   const float prefetchIORatio;
+  const uint64_t prefetchMaxDepth;
 
   const bool useReadCaching;
   const bool useWriteCaching;
   const bool useReadPrefetch;
+  const bool useDestage;
+  const float destageLowWatermark;
+  const float destageHighWatermark;
 
-  Request lastRequest;
-  bool prefetchEnabled;
-  uint32_t hitCounter;
-  uint32_t accessCounter;
+  std::vector<PrefetchStream> streams;
+  uint64_t streamAccessCounter;
 
   EVICT_POLICY policy;
   std::function<uint32_t(uint32_t, uint64_t &)> evictFunction;
-  std::function<Line *(Line *, Line *)> compareFunction;
+  std::function<Line *(DirtyList &, uint64_t &)> selectFunction;
   std::random_device rd;
   std::mt19937 gen;
   std::uniform_int_distribution<> dist;
 
+  Line *lines;  //!< All sets in one array
   std::vector<Line *> cacheData;
   std::vector<Line **> evictData;
 
+  // Valid lines by tag, as (set << 32 | way). Lines must be updated through
+  // setLine to keep this consistent.
+  std::unordered_multimap<uint64_t, uint64_t> tagIndex;
+
+  // Valid and dirty lines of each I/O position (row * parallelIO + col), in
+  // eviction order of policy
+  std::vector<DirtyList> dirtyList;
+  uint64_t dirtyCount;
+
+  // Destage
+  bool bDestage;
+  uint64_t lastRequestFinishedAt;
+  uint64_t lastDestageFinishedAt;
+
+  // 2Q policy, per set
+  uint32_t a1inSize;  //!< Max lines in A1in before it is evicted first
+  uint32_t a1outSize;
+  std::vector<WayLink> wayLink;  //!< Per line, same layout as lines
+  std::vector<WayQueue> a1in;
+  std::vector<WayQueue> am;
+  std::vector<std::list<uint64_t>> a1out;  //!< Ghost tags evicted from A1in
+  std::unordered_map<uint64_t, std::list<uint64_t>::iterator> a1outIndex;
+
   uint32_t calcSetIndex(uint64_t);
   void calcIOPosition(uint64_t, uint32_t &, uint32_t &);
 
+  void setLine(Line *, bool, bool, uint64_t);
+  void touchLine(Line *);
+  void pushQueue(uint32_t, uint32_t, QUEUE_TYPE);
+  void popQueue(uint32_t, uint32_t);
+  DirtyList &getDirtyList(uint64_t);
+
   uint32_t getEmptyWay(uint32_t, uint64_t &);
   uint32_t getValidWay(uint64_t, uint64_t &);
-  void checkPrefetch(Request &);
+  PrefetchStream *checkPrefetch(Request &);
+  void shrinkPrefetch(uint64_t);
+  void readLines(Request &, uint64_t, uint64_t, uint64_t &);
 
+  void writeBack(std::vector<uint64_t> &, std::vector<uint64_t> &,
+                 uint64_t &);
   void evictCache(uint64_t);
+  void doDestage(uint64_t);
 
   // Stats
   struct {
     uint64_t request[2];
     uint64_t cache[2];
+    uint64_t destageCount;
+    uint64_t destagedLines;
+    uint64_t destageTime;
+    uint64_t prefetchLines;
+    uint64_t prefetchHit;
+    uint64_t prefetchWasted;
   } stat;
 
  public:
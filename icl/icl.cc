@@ -30,14 +30,7 @@ namespace SimpleSSD {
 namespace ICL {
 
 ICL::ICL(ConfigReader *c) : pConf(c) {
-  pFTL = new FTL::FTL(pConf);
-
-  FTL::Parameter *param = pFTL->getInfo();
-
-  totalLogicalPages =
-      param->totalLogicalBlocks * param->pagesInBlock * param->ioUnitInPage;
-  logicalPageSize = param->pageSize / param->ioUnitInPage;
-
+  // FTL may keep its mapping table in DRAM, so create DRAM first
   switch (pConf->dramConfig.readInt(DRAM::DRAM_MODEL)) {
     case DRAM::SIMPLE_MODEL:
       pDRAM = new DRAM::SimpleDRAM(pConf->dramConfig);
@@ -49,6 +42,14 @@ ICL::ICL(ConfigReader *c) : pConf(c) {
       break;
   }
 
+  pFTL = new FTL::FTL(pConf, pDRAM);
+
+  FTL::Parameter *param = pFTL->getInfo();
+
+  totalLogicalPages =
+      param->totalLogicalBlocks * param->pagesInBlock * param->ioUnitInPage;
+  logicalPageSize = param->pageSize / param->ioUnitInPage;
+
   pCache = new GenericCache(pConf, pFTL, pDRAM);
 }
 
@@ -152,26 +153,10 @@ void ICL::flush(Request &req, uint64_t &tick) {
 }
 
 void ICL::trim(Request &req, uint64_t &tick) {
-  uint64_t beginAt;
   uint64_t finishedAt = tick;
-  uint64_t reqRemain = req.length;
-  Request reqInternal;
-
-  reqInternal.reqID = req.reqID;
-  reqInternal.offset = req.offset;
 
-  for (uint64_t i = 0; i < req.range.nlp; i++) {
-    beginAt = tick;
-
-    reqInternal.reqSubID = i + 1;
-    reqInternal.range.slpn = req.range.slpn + i;
-    reqInternal.length = MIN(reqRemain, logicalPageSize - reqInternal.offset);
-    pCache->trim(reqInternal, beginAt);
-    reqRemain -= reqInternal.length;
-    reqInternal.offset = 0;
-
-    finishedAt = MAX(finishedAt, beginAt);
-  }
+  // Whole range is handed over at once, so FTL can trim it in one pass
+  pCache->trim(req, finishedAt);
 
   Logger::debugprint(Logger::LOG_ICL,
                      "TRIM  | LCA %" PRIu64 " + %" PRIu64 " | %" PRIu64
@@ -103,6 +103,7 @@ const std::string logName[LOG_NUM] = {
     "FTL",                //!< LOG_FTL
     "FTL::FTLOLD",        //!< LOG_FTL_OLD
     "FTL::PageMapping",   //!< LOG_FTL_PAGE_MAPPING
+    "FTL::NKMapping",     //!< LOG_FTL_NK_MAPPING
     "PAL",                //!< LOG_PAL
     "PAL::PALOLD",        //!< LOG_PAL_OLD
 };
@@ -35,6 +35,7 @@ typedef enum {
   LOG_FTL,
   LOG_FTL_OLD,
   LOG_FTL_PAGE_MAPPING,
+  LOG_FTL_NK_MAPPING,
   LOG_PAL,
   LOG_PAL_OLD,
   LOG_NUM
@@ -40,6 +40,10 @@ class AbstractPAL : public StatObject {
   virtual void read(Request &, uint64_t &) = 0;
   virtual void write(Request &, uint64_t &) = 0;
   virtual void erase(Request &, uint64_t &) = 0;
+  virtual void copyback(Request &, uint32_t, uint32_t, uint64_t &) = 0;
+
+  virtual bool isLSBPage(uint32_t) = 0;
+  virtual uint64_t getBusyUntil(uint32_t) = 0;
 };
 
 }  // namespace PAL
@@ -382,114 +382,7 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
         InsertFreeSlot(ChFreeSlots[reqCh], latANTI * 2, DMA0tickFrom, tickDMA0,
                        ChStartPoint[reqCh], 1);
         //******************************************************************//
-#if 1
-      // Manage MergedTimeSlots
-      if (MergedTimeSlots[0] == NULL) {
-        MergedTimeSlots[0] = new TimeSlot(
-            tsMEM->StartTick, tsMEM->EndTick - tsMEM->StartTick + 1);
-      }
-      else {
-        TimeSlot *cur = MergedTimeSlots[0];
-        uint64_t s = tsMEM->StartTick;
-        uint64_t e = tsMEM->EndTick;
-        TimeSlot *spos = NULL, *epos = NULL;
-        int spnt = 0, epnt = 0;  // inside(0), rightside(1)
-
-        // find s position
-        cur = MergedTimeSlots[0];
-        while (cur) {
-          if (cur->StartTick <= s && s <= cur->EndTick) {
-            spos = cur;
-            spnt = 0;  // inside
-            break;
-          }
-
-          if ((cur->Next == NULL) ||
-              (cur->Next && (s < cur->Next->StartTick))) {
-            spos = cur;
-            spnt = 1;  // rightside
-            break;
-          }
-
-          cur = cur->Next;
-        }
-
-        // find e position
-        cur = MergedTimeSlots[0];
-        while (cur) {
-          if (cur->StartTick <= e && e <= cur->EndTick) {
-            epos = cur;
-            epnt = 0;  // inside
-            break;
-          }
-
-          if ((cur->Next == NULL) ||
-              (cur->Next && (e < cur->Next->StartTick))) {
-            epos = cur;
-            epnt = 1;  // rightside
-            break;
-          }
-          cur = cur->Next;
-        }
-
-        // merge
-        if (!((spos || epos) &&
-              (spos == epos && spnt == 0 &&
-               epnt == 0)))  // if both side is in a merged slot, skip
-        {
-          if (spos) {
-            if (spnt == 1)  // rightside
-            {
-              TimeSlot *tmp = new TimeSlot(
-                  tsMEM->StartTick, tsMEM->EndTick - tsMEM->StartTick +
-                                        1);  // duration will be updated later
-              tmp->Next = spos->Next;
-              if (spos == epos) {
-                epos = tmp;
-              }
-              spos->Next = tmp;  // overlapping temporary now;
-              spos = tmp;        // update spos
-            }
-          }
-          else {
-            if (!epos)  // both new
-            {
-              TimeSlot *tmp = new TimeSlot(
-                  tsMEM->StartTick,
-                  tsMEM->EndTick - tsMEM->StartTick + 1);  // copy one
-              tmp->Next = MergedTimeSlots[0];
-              MergedTimeSlots[0] = tmp;
-            }
-            else if (epos) {
-              TimeSlot *tmp = new TimeSlot(
-                  tsMEM->StartTick, 999);  // duration will be updated later
-              tmp->Next = MergedTimeSlots[0];
-              MergedTimeSlots[0] = tmp;
-              spos = tmp;
-            }
-          }
-
-          if (epos) {
-            if (epnt == 0) {
-              spos->EndTick = epos->EndTick;
-            }
-            else if (epnt == 1) {
-              spos->EndTick = tsMEM->EndTick;
-            }
-            // remove [ spos->Next ~ epos ]
-            cur = spos->Next;
-            spos->Next = epos->Next;
-            while (cur) {
-              TimeSlot *rem = cur;
-              cur = cur->Next;
-              delete rem;
-              if (rem == epos)
-                break;
-            }
-          }
-        }
-      }
-#endif  // END MERGE TIMESLOT
+      MergeBusyTime(tsMEM);
     }
 
       // print Log
@@ -567,6 +460,177 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
   }
 }
 
+// Copyback moves a page inside one plane through its page register, so it
+// occupies the die for read + program time and never uses the channel.
+void PAL2::CopybackScheduling(Command &req, CPDPBP &srcCPD, CPDPBP &dstCPD) {
+  uint32_t reqDieIdx = CPDPBPtoDieIdx(&srcCPD);
+  TimeSlot *tsMEM = NULL;
+  uint64_t latMEM, MEMtickFrom, tickMEM;
+  bool conflicts;
+
+  latMEM = lat->GetLatency(srcCPD.Page, OPER_READ, BUSY_MEM) +
+           lat->GetLatency(dstCPD.Page, OPER_WRITE, BUSY_MEM);
+
+  // Find MEM available slot in DieTimeSlots
+  MEMtickFrom = req.arrived;
+  if (!FindFreeTime(DieFreeSlots[reqDieIdx], latMEM, MEMtickFrom, tickMEM,
+                    conflicts)) {
+    if (MEMtickFrom < DieStartPoint[reqDieIdx]) {
+      MEMtickFrom = DieStartPoint[reqDieIdx];
+    }
+    tickMEM = DieStartPoint[reqDieIdx];
+  }
+  else {
+    if (conflicts)
+      MEMtickFrom = tickMEM;
+  }
+
+  InsertFreeSlot(DieFreeSlots[reqDieIdx], latMEM, MEMtickFrom, tickMEM,
+                 DieStartPoint[reqDieIdx], 0);
+
+  tsMEM = new TimeSlot(MEMtickFrom, latMEM);
+
+  MergeBusyTime(tsMEM);
+
+  req.finished = MEMtickFrom + latMEM;
+
+  // Copyback is accounted as program operation
+  std::map<uint64_t, uint64_t>::iterator e;
+  e = OpTimeStamp[req.operation].find(tsMEM->StartTick);
+  if (e != OpTimeStamp[req.operation].end()) {
+    if (e->second < tsMEM->EndTick)
+      e->second = tsMEM->EndTick;
+  }
+  else {
+    OpTimeStamp[req.operation][tsMEM->StartTick] = tsMEM->EndTick;
+  }
+  FlushOpTimeStamp();
+
+  // Update stats
+  stats->UpdateLastTick(req.finished);
+#if GATHER_RESOURCE_CONFLICT
+  stats->AddLatency(req, &dstCPD, reqDieIdx, NULL, tsMEM, NULL,
+                    MEMtickFrom > req.arrived ? CONFLICT_MEM : CONFLICT_NONE,
+                    MEMtickFrom - req.arrived);
+#else
+  stats->AddLatency(req, &dstCPD, reqDieIdx, NULL, tsMEM, NULL);
+#endif
+
+  delete tsMEM;
+}
+
+// Add busy time of die into MergedTimeSlots
+void PAL2::MergeBusyTime(TimeSlot *tsMEM) {
+  if (MergedTimeSlots[0] == NULL) {
+    MergedTimeSlots[0] = new TimeSlot(
+        tsMEM->StartTick, tsMEM->EndTick - tsMEM->StartTick + 1);
+  }
+  else {
+    TimeSlot *cur = MergedTimeSlots[0];
+    uint64_t s = tsMEM->StartTick;
+    uint64_t e = tsMEM->EndTick;
+    TimeSlot *spos = NULL, *epos = NULL;
+    int spnt = 0, epnt = 0;  // inside(0), rightside(1)
+
+    // find s position
+    cur = MergedTimeSlots[0];
+    while (cur) {
+      if (cur->StartTick <= s && s <= cur->EndTick) {
+        spos = cur;
+        spnt = 0;  // inside
+        break;
+      }
+
+      if ((cur->Next == NULL) ||
+          (cur->Next && (s < cur->Next->StartTick))) {
+        spos = cur;
+        spnt = 1;  // rightside
+        break;
+      }
+
+      cur = cur->Next;
+    }
+
+    // find e position
+    cur = MergedTimeSlots[0];
+    while (cur) {
+      if (cur->StartTick <= e && e <= cur->EndTick) {
+        epos = cur;
+        epnt = 0;  // inside
+        break;
+      }
+
+      if ((cur->Next == NULL) ||
+          (cur->Next && (e < cur->Next->StartTick))) {
+        epos = cur;
+        epnt = 1;  // rightside
+        break;
+      }
+      cur = cur->Next;
+    }
+
+    // merge
+    if (!((spos || epos) &&
+          (spos == epos && spnt == 0 &&
+           epnt == 0)))  // if both side is in a merged slot, skip
+    {
+      if (spos) {
+        if (spnt == 1)  // rightside
+        {
+          TimeSlot *tmp = new TimeSlot(
+              tsMEM->StartTick, tsMEM->EndTick - tsMEM->StartTick +
+                                    1);  // duration will be updated later
+          tmp->Next = spos->Next;
+          if (spos == epos) {
+            epos = tmp;
+          }
+          spos->Next = tmp;  // overlapping temporary now;
+          spos = tmp;        // update spos
+        }
+      }
+      else {
+        if (!epos)  // both new
+        {
+          TimeSlot *tmp = new TimeSlot(
+              tsMEM->StartTick,
+              tsMEM->EndTick - tsMEM->StartTick + 1);  // copy one
+          tmp->Next = MergedTimeSlots[0];
+          MergedTimeSlots[0] = tmp;
+        }
+        else if (epos) {
+          TimeSlot *tmp = new TimeSlot(
+              tsMEM->StartTick, 999);  // duration will be updated later
+          tmp->Next = MergedTimeSlots[0];
+          MergedTimeSlots[0] = tmp;
+          spos = tmp;
+        }
+      }
+
+      if (epos) {
+        if (epnt == 0) {
+          spos->EndTick = epos->EndTick;
+        }
+        else if (epnt == 1) {
+          spos->EndTick = tsMEM->EndTick;
+        }
+        // remove [ spos->Next ~ epos ]
+        // (nothing to remove when both ends fall on the same slot)
+        if (spos != epos) {
+          cur = spos->Next;
+          spos->Next = epos->Next;
+          while (cur) {
+            TimeSlot *rem = cur;
+            cur = cur->Next;
+            delete rem;
+            if (rem == epos)
+              break;
+          }
+        }
+      }
+    }
+  }
+}
+
 void PAL2::submit(Command &cmd, CPDPBP &addr) {
   TimelineScheduling(cmd, addr);
 }
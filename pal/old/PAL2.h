@@ -64,10 +64,12 @@ class PAL2  // let's not inherit PAL1
 
   void submit(Command &cmd, CPDPBP &addr);
   void TimelineScheduling(Command &req, CPDPBP &reqCPD);
+  void CopybackScheduling(Command &req, CPDPBP &srcCPD, CPDPBP &dstCPD);
   PALStatistics *stats;  // statistics of PAL2, not created by itself
   void InquireBusyTime(uint64_t currentTick);
   void FlushTimeSlots(uint64_t currentTick);
   void FlushOpTimeStamp();
+  void MergeBusyTime(TimeSlot *tsMEM);
   TimeSlot *FlushATimeSlot(TimeSlot *tgtTimeSlot, uint64_t currentTick);
   TimeSlot *FlushATimeSlotBusyTime(TimeSlot *tgtTimeSlot, uint64_t currentTick,
                                    uint64_t *TimeSum);
@@ -543,22 +543,32 @@ void PALStatistics::AddLatency(Command &CMD, CPDPBP *CPD, uint32_t dieIdx,
   TICK_IOEND, DMA1->TickEnd
   */
 
-  time_all[TICK_DMA0WAIT] =
-      DMA0->StartTick -
-      CMD.arrived;  // FETCH_WAIT --> when DMA0 couldn't start immediatly
-  time_all[TICK_DMA0] = lat->GetLatency(CPD->Page, CMD.operation, BUSY_DMA0);
+  // Copyback has no DMA, and MEM holds both read and program time
+  if (DMA0 == NULL || DMA1 == NULL) {
+    time_all[TICK_DMA0WAIT] = MEM->StartTick - CMD.arrived;
+    time_all[TICK_MEM] = MEM->EndTick - MEM->StartTick + 1;
+    time_all[TICK_FULL] = MEM->EndTick - CMD.arrived + 1;
+  }
+  else {
+    time_all[TICK_DMA0WAIT] =
+        DMA0->StartTick -
+        CMD.arrived;  // FETCH_WAIT --> when DMA0 couldn't start immediatly
+    time_all[TICK_DMA0] =
+        lat->GetLatency(CPD->Page, CMD.operation, BUSY_DMA0);
+    time_all[TICK_MEM] = lat->GetLatency(CPD->Page, CMD.operation, BUSY_MEM);
+    time_all[TICK_DMA1WAIT] =
+        (MEM->EndTick - MEM->StartTick + 1) -
+        (lat->GetLatency(CPD->Page, CMD.operation, BUSY_DMA0) +
+         lat->GetLatency(CPD->Page, CMD.operation, BUSY_MEM) +
+         lat->GetLatency(CPD->Page, CMD.operation,
+                         BUSY_DMA1));  // --> when DMA1 didn't start immediatly.
+    time_all[TICK_DMA1] =
+        lat->GetLatency(CPD->Page, CMD.operation, BUSY_DMA1);
+    time_all[TICK_FULL] =
+        DMA1->EndTick - CMD.arrived + 1;  // D0W+D0+M+D1W+D1 full latency
+  }
   time_all[TICK_DMA0_SUSPEND] = 0;  // no suspend in new design
-  time_all[TICK_MEM] = lat->GetLatency(CPD->Page, CMD.operation, BUSY_MEM);
-  time_all[TICK_DMA1WAIT] =
-      (MEM->EndTick - MEM->StartTick + 1) -
-      (lat->GetLatency(CPD->Page, CMD.operation, BUSY_DMA0) +
-       lat->GetLatency(CPD->Page, CMD.operation, BUSY_MEM) +
-       lat->GetLatency(CPD->Page, CMD.operation,
-                       BUSY_DMA1));  // --> when DMA1 didn't start immediatly.
-  time_all[TICK_DMA1] = lat->GetLatency(CPD->Page, CMD.operation, BUSY_DMA1);
   time_all[TICK_DMA1_SUSPEND] = 0;  // no suspend in new design
-  time_all[TICK_FULL] =
-      DMA1->EndTick - CMD.arrived + 1;  // D0W+D0+M+D1W+D1 full latency
   time_all[TICK_PROC] = time_all[TICK_DMA0] + time_all[TICK_MEM] +
                         time_all[TICK_DMA1];  // OPTIMUM_TIME
 
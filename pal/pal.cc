@@ -132,9 +132,17 @@ void PAL::erase(Request &req, uint64_t &tick) {
   pPAL->erase(req, tick);
 }
 
-void PAL::copyback(uint32_t blockIndex, uint32_t oldPageIndex,
-                   uint32_t newPageIndex, uint64_t &tick) {
-  Logger::panic("Copyback not implemented");
+void PAL::copyback(Request &req, uint32_t blockIndex, uint32_t pageIndex,
+                   uint64_t &tick) {
+  pPAL->copyback(req, blockIndex, pageIndex, tick);
+}
+
+bool PAL::isLSBPage(uint32_t pageIndex) {
+  return pPAL->isLSBPage(pageIndex);
+}
+
+uint64_t PAL::getBusyUntil(uint32_t blockIndex) {
+  return pPAL->getBusyUntil(blockIndex);
 }
 
 Parameter *PAL::getInfo() {
@@ -56,7 +56,10 @@ class PAL : public StatObject {
   void read(Request &, uint64_t &);
   void write(Request &, uint64_t &);
   void erase(Request &, uint64_t &);
-  void copyback(uint32_t, uint32_t, uint32_t, uint64_t &);
+  void copyback(Request &, uint32_t, uint32_t, uint64_t &);
+
+  bool isLSBPage(uint32_t);
+  uint64_t getBusyUntil(uint32_t);
 
   Parameter *getInfo();
 
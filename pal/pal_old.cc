@@ -138,6 +138,66 @@ void PALOLD::erase(Request &req, uint64_t &tick) {
   tick = finishedAt;
 }
 
+void PALOLD::copyback(Request &req, uint32_t blockIndex, uint32_t pageIndex,
+                      uint64_t &tick) {
+  uint64_t finishedAt = tick;
+  ::Command cmd(tick, 0, OPER_WRITE, param.superPageSize);
+  std::vector<::CPDPBP> src;
+  std::vector<::CPDPBP> dst;
+  Request target(req);
+
+  target.blockIndex = blockIndex;
+  target.pageIndex = pageIndex;
+
+  printPPN(req, "CBSRC");
+  printPPN(target, "CBDST");
+
+  convertCPDPBP(req, src);
+  convertCPDPBP(target, dst);
+
+  for (uint32_t i = 0; i < src.size(); i++) {
+    // Copyback cannot cross plane boundary
+    if (src.at(i).Channel != dst.at(i).Channel ||
+        src.at(i).Package != dst.at(i).Package ||
+        src.at(i).Die != dst.at(i).Die || src.at(i).Plane != dst.at(i).Plane) {
+      Logger::panic("Copyback source and destination are on different plane");
+    }
+
+    printCPDPBP(src.at(i), "CBSRC");
+    printCPDPBP(dst.at(i), "CBDST");
+
+    pal->CopybackScheduling(cmd, src.at(i), dst.at(i));
+
+    finishedAt = MAX(finishedAt, cmd.finished);
+  }
+
+  tick = finishedAt;
+}
+
+bool PALOLD::isLSBPage(uint32_t pageIndex) {
+  return lat->GetPageType(pageIndex) == PAGE_LSB;
+}
+
+uint64_t PALOLD::getBusyUntil(uint32_t blockIndex) {
+  Request req(param.pageInSuperPage);
+  std::vector<::CPDPBP> list;
+  uint64_t tick = 0;
+
+  req.blockIndex = blockIndex;
+  req.pageIndex = 0;
+  req.ioFlag.set();
+
+  convertCPDPBP(req, list);
+
+  // Rightmost free slot of die starts after last scheduled operation
+  // Channel is not checked, as DMA fills gaps between other operations
+  for (auto &iter : list) {
+    tick = MAX(tick, pal->DieStartPoint[pal->CPDPBPtoDieIdx(&iter)]);
+  }
+
+  return tick;
+}
+
 void PALOLD::convertCPDPBP(Request &req, std::vector<::CPDPBP> &list) {
   ::CPDPBP addr;
   static uint32_t pageAllocation = conf.getPageAllocationConfig();
@@ -51,6 +51,10 @@ class PALOLD : public AbstractPAL {
   void read(Request &, uint64_t &) override;
   void write(Request &, uint64_t &) override;
   void erase(Request &, uint64_t &) override;
+  void copyback(Request &, uint32_t, uint32_t, uint64_t &) override;
+
+  bool isLSBPage(uint32_t) override;
+  uint64_t getBusyUntil(uint32_t) override;
 };
 
 }  // namespace PAL